@@ -1,9 +1,15 @@
 #define _GNU_SOURCE
+#include <arpa/inet.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <errno.h>
 #include <fcntl.h>
+#include <getopt.h>
 #include <float.h>
 #include <inttypes.h>
 #include <limits.h>
 #include <math.h>
+#include <poll.h>
 #include <pthread.h>
 #include <sched.h>
 #include <stdarg.h>
@@ -12,14 +18,24 @@
 #include <string.h>
 #include <sys/mman.h>
 #include <sys/prctl.h>
+#include <sys/socket.h>
 #include <sys/stat.h>
+#include <sys/time.h>
 #include <sys/times.h>
 #include <sys/types.h>
+#include <sys/un.h>
 #include <time.h>
 #include <unistd.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 #include <libxml/parser.h>
-#include <libxml/tree.h>
+#include <libxml/xmlreader.h>
 
 #define printf_once(fmt, ...)			\
 ({						\
@@ -121,7 +137,8 @@ void list_add(struct list_head *head, struct list_head *new)
 
 void list_del(struct list_head *head, struct list_head *entry)
 {
-	head->next = entry->next;
+	entry->prev->next = entry->next;
+	entry->next->prev = entry->prev;
 	entry->next = entry;
 	entry->prev = entry;
 
@@ -133,349 +150,143 @@ int list_empty(struct list_head *head)
 	return head->next == head;
 }
 
-struct rb_node
-{
-	intptr_t rb_parent_color;
-#define	RB_RED		0
-#define	RB_BLACK	1
-	struct rb_node *rb_right;
-	struct rb_node *rb_left;
-} __attribute__((aligned(sizeof(long))));
+/*
+ * String interning: every distinct name is stored once, in blocks that
+ * never move, and gets a dense id. An open-addressing table (linear
+ * probing, at most half full) maps a name to its id.
+ */
+#define STRTAB_BLOCK	65536
 
-struct rb_root
-{
-	struct rb_node *rb_node;
-};
+struct strtab {
+	char *blk;		/* current block, chained through its	*/
+	size_t used;		/* first word; bytes used in it and	*/
+	size_t room;		/* its size				*/
 
-struct rb_tree {
-	struct rb_root root;
-	struct rb_node *leftmost;
+	const char **str;	/* strings, by id			*/
+	uint32_t *hash;		/* hash of each string			*/
+	int nstr, strcap;
 
-	unsigned int dim;
+	int *slot;		/* per slot, id + 1 of a string or 0	*/
+	int nslot;		/* size of slot (a power of two)	*/
 };
 
-#define rb_parent(r)   ((struct rb_node *)((r)->rb_parent_color & ~3))
-#define rb_color(r)   ((r)->rb_parent_color & 1)
-#define rb_is_red(r)   (!rb_color(r))
-#define rb_is_black(r) rb_color(r)
-#define rb_set_red(r)  do { (r)->rb_parent_color &= ~1; } while (0)
-#define rb_set_black(r)  do { (r)->rb_parent_color |= 1; } while (0)
-
-#define RB_ROOT	(struct rb_root) { NULL, }
-#define	rb_entry(ptr, type, member) container_of(ptr, type, member)
-
-#define RB_EMPTY_ROOT(root)	((root)->rb_node == NULL)
-#define RB_EMPTY_NODE(node)	(rb_parent(node) == node)
-#define RB_CLEAR_NODE(node)	(rb_set_parent(node, node))
-
-void rb_tree_init(struct rb_tree *t)
-{
-	t->root = RB_ROOT;
-	t->leftmost = NULL;
-	t->dim = 0;
-}
-
-void rb_set_parent(struct rb_node *rb, struct rb_node *p)
+uint32_t strtab_hash(const char *s)
 {
-	rb->rb_parent_color = (rb->rb_parent_color & 3) | (uintptr_t)p;
-}
-
-void rb_set_color(struct rb_node *rb, int color)
-{
-	rb->rb_parent_color = (rb->rb_parent_color & ~1) | color;
-}
+	uint32_t h = 2166136261u;
 
-void rb_link_node(struct rb_node * node, struct rb_node * parent,
-		  struct rb_node ** rb_link)
-{
-	node->rb_parent_color = (uintptr_t)parent;
-	node->rb_left = node->rb_right = NULL;
+	while (*s)
+		h = (h ^ (unsigned char)*s++) * 16777619u;
 
-	*rb_link = node;
+	return h;
 }
 
-void __rb_rotate_left(struct rb_node *node, struct rb_root *root)
+int strtab_grow(struct strtab *st)
 {
-	struct rb_node *right = node->rb_right;
-	struct rb_node *parent = rb_parent(node);
-
-	if ((node->rb_right = right->rb_left))
-		rb_set_parent(right->rb_left, node);
-	right->rb_left = node;
+	int *slot, nslot = st->nslot ? 2 * st->nslot : 64;
+	int i, k;
 
-	rb_set_parent(right, parent);
+	slot = (int *)calloc(nslot, sizeof(int));
+	if (!slot)
+		return 1;
 
-	if (parent)
-	{
-		if (node == parent->rb_left)
-			parent->rb_left = right;
-		else
-			parent->rb_right = right;
+	for (i = 0; i < st->nstr; i++) {
+		k = st->hash[i] & (nslot - 1);
+		while (slot[k])
+			k = (k + 1) & (nslot - 1);
+		slot[k] = i + 1;
 	}
-	else
-		root->rb_node = right;
-	rb_set_parent(node, right);
-}
-
-void __rb_rotate_right(struct rb_node *node, struct rb_root *root)
-{
-	struct rb_node *left = node->rb_left;
-	struct rb_node *parent = rb_parent(node);
 
-	if ((node->rb_left = left->rb_right))
-		rb_set_parent(left->rb_right, node);
-	left->rb_right = node;
+	free(st->slot);
+	st->slot = slot;
+	st->nslot = nslot;
 
-	rb_set_parent(left, parent);
-
-	if (parent)
-	{
-		if (node == parent->rb_right)
-			parent->rb_right = left;
-		else
-			parent->rb_left = left;
-	}
-	else
-		root->rb_node = left;
-	rb_set_parent(node, left);
+	return 0;
 }
 
-void rb_insert_color(struct rb_node *node, struct rb_root *root)
+char *strtab_store(struct strtab *st, const char *s, size_t len)
 {
-	struct rb_node *parent, *gparent;
-
-	while ((parent = rb_parent(node)) && rb_is_red(parent)) {
-		gparent = rb_parent(parent);
-
-		if (parent == gparent->rb_left) {
-			{
-				register struct rb_node *uncle = 
-							gparent->rb_right;
-				if (uncle && rb_is_red(uncle)) {
-					rb_set_black(uncle);
-					rb_set_black(parent);
-					rb_set_red(gparent);
-					node = gparent;
-					continue;
-				}
-			}
-
-			if (parent->rb_right == node) {
-				register struct rb_node *tmp;
-				__rb_rotate_left(parent, root);
-				tmp = parent;
-				parent = node;
-				node = tmp;
-			}
+	char *blk, *p;
+	size_t room;
 
-			rb_set_black(parent);
-			rb_set_red(gparent);
-			__rb_rotate_right(gparent, root);
-		} else {
-			{
-				register struct rb_node *uncle = 
-							gparent->rb_left;
-				if (uncle && rb_is_red(uncle)) {
-					rb_set_black(uncle);
-					rb_set_black(parent);
-					rb_set_red(gparent);
-					node = gparent;
-					continue;
-				}
-			}
+	if (st->used + len > st->room) {
+		room = (len > STRTAB_BLOCK ? len : STRTAB_BLOCK) +
+		       sizeof(char *);
 
-			if (parent->rb_left == node) {
-				register struct rb_node *tmp;
-				__rb_rotate_right(parent, root);
-				tmp = parent;
-				parent = node;
-				node = tmp;
-			}
+		blk = (char *)malloc(room);
+		if (!blk)
+			return NULL;
 
-			rb_set_black(parent);
-			rb_set_red(gparent);
-			__rb_rotate_left(gparent, root);
-		}
+		*(char **)blk = st->blk;
+		st->blk = blk;
+		st->used = sizeof(char *);
+		st->room = room;
 	}
 
-	rb_set_black(root->rb_node);
-}
-
-void __rb_erase_color(struct rb_node *node, struct rb_node *parent,
-			     struct rb_root *root)
-{
-	struct rb_node *other;
+	p = st->blk + st->used;
+	memcpy(p, s, len);
+	st->used += len;
 
-	while ((!node || rb_is_black(node)) && node != root->rb_node) {
-		if (parent->rb_left == node) {
-			other = parent->rb_right;
-			if (rb_is_red(other)) {
-				rb_set_black(other);
-				rb_set_red(parent);
-				__rb_rotate_left(parent, root);
-				other = parent->rb_right;
-			}
-			if ((!other->rb_left || 
-				rb_is_black(other->rb_left)) &&
-			    (!other->rb_right || 
-				rb_is_black(other->rb_right))) {
-				rb_set_red(other);
-				node = parent;
-				parent = rb_parent(node);
-			} else {
-				if (!other->rb_right || 
-					rb_is_black(other->rb_right)) {
-					struct rb_node *o_left;
-
-					if ((o_left = other->rb_left))
-						rb_set_black(o_left);
-					rb_set_red(other);
-					__rb_rotate_right(other, root);
-					other = parent->rb_right;
-				}
-				rb_set_color(other, rb_color(parent));
-				rb_set_black(parent);
-				if (other->rb_right)
-					rb_set_black(other->rb_right);
-				__rb_rotate_left(parent, root);
-				node = root->rb_node;
-				break;
-			}
-		} else {
-			other = parent->rb_left;
-			if (rb_is_red(other)) {
-				rb_set_black(other);
-				rb_set_red(parent);
-				__rb_rotate_right(parent, root);
-				other = parent->rb_left;
-			}
-			if ((!other->rb_left || 
-				rb_is_black(other->rb_left)) &&
-			    (!other->rb_right || 
-				rb_is_black(other->rb_right))) {
-				rb_set_red(other);
-				node = parent;
-				parent = rb_parent(node);
-			} else {
-				if (!other->rb_left || 
-					rb_is_black(other->rb_left)) {
-					register struct rb_node *o_right;
-
-					if ((o_right = other->rb_right))
-						rb_set_black(o_right);
-					rb_set_red(other);
-					__rb_rotate_left(other, root);
-					other = parent->rb_left;
-				}
-				rb_set_color(other, rb_color(parent));
-				rb_set_black(parent);
-				if (other->rb_left)
-					rb_set_black(other->rb_left);
-				__rb_rotate_right(parent, root);
-				node = root->rb_node;
-				break;
-			}
-		}
-	}
-	if (node)
-		rb_set_black(node);
+	return p;
 }
 
-void rb_erase(struct rb_node *node, struct rb_root *root)
+/* id of s, added if not there yet; -1 on allocation failure */
+int strtab_intern(struct strtab *st, const char *s)
 {
-	struct rb_node *child, *parent;
-	int color;
-
-	if (!node->rb_left) {
-		child = node->rb_right;
-	} else if (!node->rb_right) {
-		child = node->rb_left;
-	} else {
-		struct rb_node *old = node, *left;
-
-		node = node->rb_right;
-		while ((left = node->rb_left) != NULL)
-			node = left;
-		child = node->rb_right;
-		parent = rb_parent(node);
-		color = rb_color(node);
-
-		if (child) {
-			rb_set_parent(child, parent);
-		} if (parent == old) {
-			parent->rb_right = child;
-			parent = node;
-		} else {
-			parent->rb_left = child;
-		}
+	uint32_t h = strtab_hash(s);
+	const char **str;
+	uint32_t *hash;
+	char *p;
+	int k, cap;
 
-		node->rb_parent_color = old->rb_parent_color;
-		node->rb_right = old->rb_right;
-		node->rb_left = old->rb_left;
+	if (2 * (st->nstr + 1) > st->nslot && strtab_grow(st))
+		return -1;
 
-		if (rb_parent(old)) {
-			if (rb_parent(old)->rb_left == old)
-				rb_parent(old)->rb_left = node;
-			else
-				rb_parent(old)->rb_right = node;
-		} else {
-			root->rb_node = node;
-		}
+	for (k = h & (st->nslot - 1); st->slot[k];
+	     k = (k + 1) & (st->nslot - 1)) {
+		int id = st->slot[k] - 1;
 
-		rb_set_parent(old->rb_left, node);
-		if (old->rb_right)
-			rb_set_parent(old->rb_right, node);
-		goto color;
+		if (st->hash[id] == h && strcmp(st->str[id], s) == 0)
+			return id;
 	}
 
-	parent = rb_parent(node);
-	color = rb_color(node);
-
-	if (child)
-		rb_set_parent(child, parent);
-	if (parent) {
-		if (parent->rb_left == node)
-			parent->rb_left = child;
-		else
-			parent->rb_right = child;
-	} else {
-		root->rb_node = child;
+	if (st->nstr == st->strcap) {
+		cap = st->strcap ? 2 * st->strcap : 64;
+		str = (const char **)realloc(st->str, cap * sizeof(char *));
+		if (!str)
+			return -1;
+		st->str = str;
+
+		hash = (uint32_t *)realloc(st->hash, cap * sizeof(uint32_t));
+		if (!hash)
+			return -1;
+		st->hash = hash;
+		st->strcap = cap;
 	}
-color:
-	if (color == RB_BLACK)
-		__rb_erase_color(child, parent, root);
-}
 
-struct rb_node *rb_first(struct rb_root *root)
-{
-	struct rb_node	*n;
+	p = strtab_store(st, s, strlen(s) + 1);
+	if (!p)
+		return -1;
 
-	n = root->rb_node;
-	if (!n)
-		return NULL;
-	while (n->rb_left)
-		n = n->rb_left;
-	return n;
+	st->str[st->nstr] = p;
+	st->hash[st->nstr] = h;
+	st->slot[k] = ++st->nstr;
+
+	return st->nstr - 1;
 }
 
-struct rb_node *rb_next(const struct rb_node *node)
+void strtab_free(struct strtab *st)
 {
-	struct rb_node *parent;
-
-	if (RB_EMPTY_NODE(node))
-		return NULL;
+	while (st->blk) {
+		char *next = *(char **)st->blk;
 
-	if (node->rb_right) {
-		node = node->rb_right; 
-		while (node->rb_left)
-			node=node->rb_left;
-		return (struct rb_node *)node;
+		free(st->blk);
+		st->blk = next;
 	}
 
-	while ((parent = rb_parent(node)) && node == parent->rb_right)
-		node = parent;
-
-	return parent;
+	free(st->str);
+	free(st->hash);
+	free(st->slot);
+	memset(st, 0, sizeof(*st));
 }
 
 void swap(void *a, void *b, int size)
@@ -492,7 +303,7 @@ void swap(void *a, void *b, int size)
 void sort(void *base, size_t num, size_t size,
 	  int (*cmp)(const void *, const void *))
 {
-	int i = (num/2 - 1) * size, n = num * size, c, r;
+	long i = (long)(num/2) * size - size, n = num * size, c, r;
 
 	for ( ; i >= 0; i -= size) {
 		for (r = i; r * 2 + size < n; r  = c) {
@@ -520,141 +331,369 @@ void sort(void *base, size_t num, size_t size,
 	}
 }
 
-#define PRIO_MIN	0
-#define PRIO_MAX	100
-struct vert {
-	int id;			/* vertex id				*/
-	char name[256];		/* vertex name				*/
+/* wall and CPU (all threads) time spent in one phase, in seconds */
+struct phase {
+	double wall;
+	double cpu;
+};
 
-	struct list_head pred;	/* list of predecessors			*/
-	struct list_head succ;	/* list of successors			*/
+struct phase_clock {
+	struct timespec wall;
+	struct timespec cpu;
+};
 
-	struct task *t;		/* task this vertex belongs to		*/
-	struct cl_node *n;	/* node this vertex belongs to		*/
+void phase_start(struct phase_clock *c)
+{
+	clock_gettime(CLOCK_MONOTONIC, &c->wall);
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &c->cpu);
+}
 
-	double e;		/* execution time			*/
-	double prob;		/* probability WCET < e			*/
-	double l_to;		/* len of crit.path to this vertex	*/
-	double l_from;		/* len of crit.path from this vertex	*/
-	double u;		/* utilization				*/
+void phase_stop(struct phase_clock *c, struct phase *p)
+{
+	struct timespec wall, cpu;
 
-	double resp;		/* response time			*/
-	double tard;		/* resp - d				*/
+	clock_gettime(CLOCK_MONOTONIC, &wall);
+	clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &cpu);
 
-	double x;		/* X_v (for RTA)			*/
-	double y;		/* Y_v (for RTA)			*/
+	p->wall += (wall.tv_sec - c->wall.tv_sec) +
+		   (wall.tv_nsec - c->wall.tv_nsec) / 1e9;
+	p->cpu += (cpu.tv_sec - c->cpu.tv_sec) +
+		  (cpu.tv_nsec - c->cpu.tv_nsec) / 1e9;
+}
 
-	int prio;		/* priority of this vertex		*/
+/*
+ * Times are integer ticks, tick_res of them per time unit of the model.
+ * Model values are rounded to ticks against the analysis (WCETs up,
+ * deadlines and periods down) and results are printed in model units.
+ * No time exceeds TICK_MAX, so sums of a few of them cannot overflow.
+ */
+typedef int64_t tick_t;
 
-	struct rb_node node;
-};
-struct rb_tree verts;
+#define TICK_MAX	(INT64_MAX / 4)
+#define TICK_RES_MAX	1000000000
+#define TARD_TOL	10000000000LL	/* in model time units		*/
+
+int64_t tick_res = 1;
+int tick_prec;			/* decimals of a tick in model units	*/
+tick_t tick_tol = TARD_TOL;	/* TARD_TOL in ticks		*/
+
+/* a power of ten, so that ticks print exactly with tick_prec decimals */
+int tick_set_res(int64_t res)
+{
+	int64_t r;
+	int prec;
+
+	if (res < 1 || res > TICK_RES_MAX)
+		return 1;
+
+	for (prec = 0, r = 1; r < res; r *= 10)
+		prec++;
+	if (r != res)
+		return 1;
+
+	tick_res = res;
+	tick_prec = prec;
+	tick_tol = TARD_TOL > TICK_MAX / res ? TICK_MAX : TARD_TOL * res;
+
+	return 0;
+}
+
+/* a + b for a, b in [0, TICK_MAX], saturated at TICK_MAX */
+tick_t tick_add(tick_t a, tick_t b)
+{
+	return a + b > TICK_MAX ? TICK_MAX : a + b;
+}
 
-int vert_before(struct vert *v1, struct vert *v2)
+/* floor(a / b) for b > 0 */
+tick_t tick_div(tick_t a, int b)
 {
-	return strcmp(v1->name, v2->name) < 0;
+	return a >= 0 ? a / b : -((-a + b - 1) / b);
 }
 
-int verts_insert(struct rb_tree *verts, struct vert *v)
+/* for printing */
+double tick_unit(tick_t t)
 {
-	struct rb_node **link = &verts->root.rb_node;
-	struct rb_node *parent = NULL;
-	struct vert *entry;
-	int leftmost = 1;
+	return (double)t / tick_res;
+}
 
-	if (!RB_EMPTY_NODE(&v->node))
-		return 1;
+/* t in model units with tick_prec decimals, somewhere in buf[32] */
+char *tick_str(tick_t t, char *buf)
+{
+	uint64_t u = t < 0 ? -(uint64_t)t : (uint64_t)t;
+	char *p = buf + 32;
+	int i;
 
-	while (*link) {
-		parent = *link;
-		entry = rb_entry(parent, struct vert, node);
-		if (vert_before(v, entry)) {
-			link = &parent->rb_left;
-		} else {
-			link = &parent->rb_right;
-			leftmost = 0;
-		}
+	*--p = '\0';
+	for (i = 0; i < tick_prec; i++) {
+		*--p = '0' + u % 10;
+		u /= 10;
 	}
+	if (tick_prec)
+		*--p = '.';
 
-	if (leftmost)
-		verts->leftmost = &v->node;
+	do {
+		*--p = '0' + u % 10;
+		u /= 10;
+	} while (u);
 
-	rb_link_node(&v->node, parent, link);
-	rb_insert_color(&v->node, &verts->root);
+	if (t < 0)
+		*--p = '-';
 
-	verts->dim++;
-	return 0;
+	return p;
 }
 
-struct vert *verts_search(struct rb_tree *verts,
-			  const char *name)
+/*
+ * Parse a decimal time in model units into ticks, rounding up or down.
+ * Only fractional digits up to the tick matter for the result, so
+ * there is no binary floating point on the way.
+ */
+int tick_parse(const char *str, int up, tick_t *t)
 {
-        struct rb_node *node = verts->root.rb_node;
-	struct vert val;
+	int64_t ip = 0, fp = 0, scale = 1, q;
+	int neg = 0, nd = 0, rest = 0;
+	const char *s = str;
 
-	memset(val.name, 0, 256);
-	strcpy(val.name, name);
+	s += strspn(s, " \t\r\n");
+	if (*s == '-' || *s == '+')
+		neg = *s++ == '-';
 
-        while (node) {
-		struct vert *v = rb_entry(node, struct vert, node);
+	for (; isdigit((unsigned char)*s); s++, nd++) {
+		if (ip > TICK_MAX / 10)
+			return 1;
+		ip = ip * 10 + (*s - '0');
+	}
 
-		if (vert_before(&val, v))
-			node = node->rb_left;
-		else if (vert_before(v, &val))
-			node = node->rb_right;
-		else
-			return v;
-  	}
+	if (*s == '.') {
+		for (s++; isdigit((unsigned char)*s); s++, nd++) {
+			if (scale < TICK_RES_MAX) {
+				fp = fp * 10 + (*s - '0');
+				scale *= 10;
+			} else if (*s != '0') {
+				rest = 1;
+			}
+		}
+	}
 
-	return NULL;
+	s += strspn(s, " \t\r\n");
+	if (!nd || *s || ip > TICK_MAX / tick_res)
+		return 1;
+
+	/* fp < scale <= TICK_RES_MAX, and so is tick_res */
+	q = fp * tick_res / scale;
+	rest |= fp * tick_res % scale != 0;
+
+	*t = ip * tick_res + q;
+	if (rest && up != neg)
+		(*t)++;
+	if (*t > TICK_MAX)
+		return 1;
+	if (neg)
+		*t = -*t;
+
+	return 0;
 }
 
+#define PRIO_MIN	0
+#define PRIO_MAX	100
+/*
+ * Fields read by every round of rta() come first; the analysis itself
+ * reads e, period and Y of the interferers from the per-node arrays of
+ * the taskset (see rta_hot()), not from here.
+ */
+struct vert {
+	tick_t x;		/* X_v (for RTA)			*/
+	tick_t y;		/* Y_v (for RTA)			*/
+	tick_t e;		/* execution time			*/
+	tick_t sub;		/* e of same-task interferers reachable
+				   from this vertex			*/
+
+	int prio;		/* priority of this vertex		*/
+	int ni;			/* # of interferers (prefix of n->iv)	*/
+	int pos;		/* index in the taskset hot arrays	*/
+
+	int yc;			/* Y_v changed in the last update	*/
+	int sr;			/* last round X_v changed		*/
+	uint64_t upd;		/* rounds in which X_v < Y_v		*/
+
+	struct task *t;		/* task this vertex belongs to		*/
+	struct cl_node *n;	/* node this vertex belongs to		*/
+
+	int id;			/* vertex id				*/
+	int mark;		/* scratch flags for what-if analysis	*/
+
+	double prob;		/* probability WCET < e			*/
+	tick_t best;		/* best-case and typical execution	*/
+	tick_t value;		/* times, best <= value <= e		*/
+	tick_t ys;		/* saved Y to start from (ts->ystart)	*/
+	tick_t l_to;		/* len of crit.path to this vertex	*/
+	tick_t l_from;		/* len of crit.path from this vertex	*/
+	double u;		/* utilization				*/
+
+	tick_t resp;		/* response time			*/
+	tick_t tard;		/* resp - d				*/
+
+	const char *name;	/* vertex name (interned)		*/
+};
+
 #define CPUNODE	0
 #define IONODE	1
 struct cl_node {
-	char name[256];		/* node name				*/
+	const char *name;	/* node name (interned)			*/
 	int type;		/* node type (CPUNODE or IONODE)	*/
 
 	int cpus;		/* # of CPUs in this node (if CPUNODE)  */
 
+	int idx;		/* index in taskset node table		*/
+	int base;		/* offset in taskset hot arrays		*/
+	struct vert **iv;	/* vertices on this node, by dec. prio	*/
+	int niv;		/* number of vertices on this node	*/
+
+	int chg[2];		/* top prio whose Y changed, by round	*/
+
+	int wf;			/* what-if: top prio of dependents seen	*/
+	int wb;			/* what-if: interferers already seen	*/
+
+	tick_t load;		/* e of its vertices, for rta_pretest()	*/
+
 	struct list_head lnode;
 };
-struct list_head nodes;
 
 struct task {
 	int id;			/* task id				*/
-	char name[256];		/* task name				*/
+	const char *name;	/* task name (interned)			*/
 
 	struct vert *v;		/* vertices				*/
 	int nv;			/* number of vertices			*/
 
-	double d;		/* deadline				*/
-	double p;		/* period				*/
+	struct list_head nodes;	/* nodes of this application		*/
+	struct cl_node *nbuf;	/* block holding them, NULL if they	*/
+				/* were allocated one by one		*/
+
+	tick_t d;		/* deadline				*/
+	tick_t p;		/* period				*/
 
-	double vol;		/* volume				*/
-	double len;		/* length				*/
+	tick_t vol;		/* volume				*/
+	tick_t len;		/* length				*/
 	double u;		/* utilization				*/
 
-	double resp;		/* response time			*/
-	double tard;		/* resp - d				*/
+	tick_t resp;		/* response time			*/
+	tick_t tard;		/* resp - d				*/
+
+	unsigned int dirty;	/* DIRTY_* state not yet recomputed	*/
+
+	int *topo;		/* vertices in topological order	*/
+	int *rank;		/* position of each vertex in topo	*/
+
+	uint64_t *reach;	/* transitive closure (dense bitset)	*/
+	int rw;			/* 64-bit words per reach row		*/
+
+	int *ri_off;		/* transitive closure (compact form):	*/
+	int *ri;		/* sorted [lo, hi] intervals of ranks	*/
+	int mapped;		/* the five arrays above are borrowed
+				   from a compiled model mapping	*/
+
+	int *succ_off;		/* successors of vertex i (CSR):	*/
+	int *succ;		/* succ[succ_off[i] .. succ_off[i + 1])	*/
+	int *pred_off;		/* predecessors, likewise		*/
+	int *pred;
+	int ne;			/* number of edges			*/
+	int *arena;		/* block holding the four arrays above,
+				   NULL if borrowed from a mapping	*/
+
+	int *el;		/* edges added since the arrays were	*/
+	int nel, elcap;		/* built, as (from, to) pairs		*/
+
+	struct phase closure;	/* time spent building the closure	*/
+	struct phase length;	/* and the critical paths		*/
+	uint64_t nreach;	/* task_reachable() queries		*/
+};
+
+/*
+ * Edits only record what they invalidate; derived data is recomputed
+ * by taskset_update() right before it is needed.
+ */
+#define DIRTY_GRAPH	1	/* edges: order, closure, lengths	*/
+#define DIRTY_WCET	2	/* execution times: lengths, volume	*/
+#define DIRTY_SCHED	4	/* priorities or nodes: interferers	*/
+
+/* what the analyses run on a taskset did, for --stats */
+struct rta_stats {
+	struct phase prepare;	/* interferer tables and hot arrays	*/
+	struct phase iter;	/* fixed-point iterations		*/
+	uint64_t nrta;		/* analyses, full or incremental	*/
+	uint64_t nrounds;	/* outer rounds, over all of them	*/
+	uint64_t ncapped;	/* analyses stopped by XI, not converged */
+	uint64_t ninner;	/* inner iterations			*/
+	uint64_t nterm;		/* interference terms evaluated		*/
 };
 
+#define BY_RTA		0	/* the analysis ran to its end		*/
+#define BY_BOUND	1	/* its lower-bound rounds, rta_bound()	*/
+#define BY_LENGTH	2	/* pre-test: a critical path past d	*/
+#define BY_LOAD		3	/* pre-test: more work than CPU time	*/
+
+#define XI		16	/* default cap on outer rounds		*/
+
+#define SOLVER_SWEEP	0	/* re-evaluate every vertex each round	*/
+#define SOLVER_WORKLIST	1	/* only vertices whose inputs changed	*/
+
 struct taskset {
 	struct task *t;		/* tasks				*/
 	int nt;			/* number of tasks			*/
 
 	double u;		/* utilization				*/
-};
 
-struct _vert {
-	int id;
-	struct list_head lnode;
+	unsigned int dirty;	/* DIRTY_* state not yet seen by rta()	*/
+
+	struct cl_node **n;	/* nodes hosting some vertex		*/
+	int nn;			/* number of nodes			*/
+
+	struct vert **v;	/* all vertices, grouped by node	*/
+	int nv;			/* number of vertices			*/
+
+	tick_t *he;		/* e, period and Y of the vertices of	*/
+	tick_t *hp;		/* each node, in n->iv order from	*/
+	tick_t *hy;		/* n->base on				*/
+
+	double *fe;		/* the same as doubles, for the vector	*/
+	double *fp;		/* kernel: exact while ts->vec says so	*/
+	double *fy;
+	int vec;
+
+	int nth;		/* threads used by rta()		*/
+	int solver;		/* SOLVER_SWEEP or SOLVER_WORKLIST	*/
+	int rounds;		/* outer round cap, 0 for no limit	*/
+	int exact;		/* only stop at X = Y (--exact)		*/
+
+	int verdict;		/* rta() only needs to tell sched or not */
+	int bound;		/* Y are lower bounds (rta_bound())	*/
+	int miss;		/* a deadline miss is already proven	*/
+	int ystart;		/* rta() starts from v->ys, not d + 1	*/
+	int fixed;		/* the last analysis ended at X = Y	*/
+	int capped;		/* and the round cap stopped it		*/
+	int by;			/* BY_*: what settled the last verdict	*/
+	struct task *byt;	/* task and node that failed a pre-test	*/
+	struct cl_node *byn;
+
+	int nr;			/* rounds of the last analysis		*/
+	int *nupd;		/* per round, # of vertices with X < Y	*/
+
+	tick_t *warm;		/* per round, X of each ts->v from an	*/
+	int nwarm;		/* analysis with WCETs no larger	*/
+	tick_t *traj;		/* per round, X of each ts->v, or NULL	*/
+
+	void *map;		/* compiled model this set was loaded	*/
+	size_t maplen;		/* from, if any				*/
+
+	struct strtab names;	/* names not stored in the mapping	*/
+
+	struct rta_stats st;
 };
 
 int vert_print(struct vert *v)
 {
-	struct _vert *_succ;
-	int first = 1;
+	struct task *t = v ? v->t : NULL;
+	int k;
 
 	if (!v)
 		return 1;
@@ -662,18 +701,16 @@ int vert_print(struct vert *v)
 	printf("\tchunk %s[%d]\n", v->name, v->id);
 	printf("\t      priority  = %d\n", v->prio);
 	printf("\t      schedNode = %s\n", v->n->name);
-	printf("\t      exec.time = %.0f\n", v->e);
+	printf("\t      exec.time = %.*f\n", tick_prec, tick_unit(v->e));
 	printf("\t      successors: ");
 
-	if (!list_empty(&v->succ)) {
-		list_for_each_entry(_succ, &v->succ, lnode) {
+	if (t->succ_off[v->id] < t->succ_off[v->id + 1]) {
+		for (k = t->succ_off[v->id]; k < t->succ_off[v->id + 1]; k++) {
 
-			if (first)
-				printf("[%d", _succ->id);
+			if (k == t->succ_off[v->id])
+				printf("[%d", t->succ[k]);
 			else
-				printf(", %d", _succ->id);
-
-			first = 0;
+				printf(", %d", t->succ[k]);
 		}
 
 		printf("]\n");
@@ -688,19 +725,35 @@ int vert_print(struct vert *v)
 
 int vert_stat(struct vert *v)
 {
-	struct _vert *_succ;
-	int first = 1;
-
 	if (!v)
 		return 1;
 
-	printf("%21d%14.0f     %9.0f    %s\n",
-		v->id, v->resp, v->tard, (v->tard > 0) ? "     X" : "");
+	printf("%21d%14.*f     %9.*f    %s\n", v->id,
+		tick_prec, tick_unit(v->resp), tick_prec, tick_unit(v->tard),
+		(v->tard > 0) ? "     X" : "");
 
 	return 0;
 }
 
-int task_init(struct task *t, int nv, double d, double p)
+void vert_init(struct vert *v, struct task *t, int id)
+{
+	v->id = id;
+	v->name = "";
+
+	v->t = t;
+	v->n = 0;
+
+	v->e = 0;
+	v->prob = 1.0;
+	v->best = 0;
+	v->value = 0;
+	v->ys = 0;
+
+	v->prio = PRIO_MIN;
+	v->mark = 0;
+}
+
+int task_init(struct task *t, int nv, tick_t d, tick_t p)
 {
 	int i;
 
@@ -714,24 +767,33 @@ int task_init(struct task *t, int nv, double d, double p)
 	if (!t->v)
 		return 1;
 
-	for (i = 0; i < nv; i++) {
-		t->v[i].id = i;
-		memset(t->v[i].name, 0, 256);
-
-		list_init(&t->v[i].pred);
-		list_init(&t->v[i].succ);
-
-		t->v[i].t = t;
-		t->v[i].e = 0.0;
-
-		t->v[i].prio = PRIO_MIN;
-		t->v[i].n = 0;
-	}
+	for (i = 0; i < nv; i++)
+		vert_init(&t->v[i], t, i);
 
 	t->nv = nv;
 	t->d = d;
 	t->p = p;
 
+	t->dirty = DIRTY_GRAPH | DIRTY_WCET;
+
+	t->topo = NULL;
+	t->rank = NULL;
+	t->reach = NULL;
+	t->ri_off = NULL;
+	t->ri = NULL;
+	t->mapped = 0;
+
+	t->succ_off = NULL;
+	t->succ = NULL;
+	t->pred_off = NULL;
+	t->pred = NULL;
+	t->ne = 0;
+	t->arena = NULL;
+
+	t->el = NULL;
+	t->nel = 0;
+	t->elcap = 0;
+
 	return 0;
 }
 
@@ -742,82 +804,59 @@ int task_volume(struct task *t)
 	if (!t)
 		return 1;
 
-	t->vol = 0.0;
-	for (i = 0; i < t->nv; i++)
-		t->vol += t->v[i].e;
+	t->vol = 0;
+	for (i = 0; i < t->nv; i++) {
+		t->vol = tick_add(t->vol, t->v[i].e);
+		if (t->p)
+			t->v[i].u = (double)t->v[i].e / t->p;
+	}
 
 	if (t->p)
-		t->u = t->vol / t->p;
+		t->u = (double)t->vol / t->p;
 
 	return 0;
 }
 
 int task_length(struct task *t)
 {
-	double *l_tmp;
-	int i, iter;
+	int i, k;
 
-	if (!t)
+	if (!t || !t->topo)
 		return 1;
 
-	l_tmp = (double *)malloc(t->nv * sizeof(double));
-	if (!l_tmp)
-		return;
-
 	for (i = 0; i < t->nv; i++) {
-		t->v[i].l_to = t->v[i].e;
-		l_tmp[i] = t->v[i].e;
-	}
-
-	for (iter = 0; iter < t->nv; iter++) {
-
-	for (i = 0; i < t->nv; i++) {
-		struct _vert *_v;
+		struct vert *v = &t->v[t->topo[i]];
 
-		list_for_each_entry(_v, &t->v[i].pred, lnode) {
-			if (t->v[i].e + l_tmp[_v->id] > t->v[i].l_to)
-				t->v[i].l_to = t->v[i].e + l_tmp[_v->id];
+		v->l_to = 0;
+		for (k = t->pred_off[v->id]; k < t->pred_off[v->id + 1]; k++) {
+			if (t->v[t->pred[k]].l_to > v->l_to)
+				v->l_to = t->v[t->pred[k]].l_to;
 		}
+		v->l_to = tick_add(v->l_to, v->e);
 	}
 
-	for (i = 0; i < t->nv; i++)
-		l_tmp[i] = t->v[i].l_to;
-	}
-
-	for (i = 0; i < t->nv; i++) {
-		t->v[i].l_from = t->v[i].e;
-		l_tmp[i] = t->v[i].e;
-	}
-
-	for (iter = 0; iter < t->nv; iter++) {
-
-	for (i = 0; i < t->nv; i++) {
-		struct _vert *_v;
+	t->len = 0;
+	for (i = t->nv - 1; i >= 0; i--) {
+		struct vert *v = &t->v[t->topo[i]];
 
-		list_for_each_entry(_v, &t->v[i].succ, lnode) {
-			if (t->v[i].e + l_tmp[_v->id] > t->v[i].l_from)
-				t->v[i].l_from = t->v[i].e + l_tmp[_v->id];
+		v->l_from = 0;
+		for (k = t->succ_off[v->id]; k < t->succ_off[v->id + 1]; k++) {
+			if (t->v[t->succ[k]].l_from > v->l_from)
+				v->l_from = t->v[t->succ[k]].l_from;
 		}
-	}
-
-	for (i = 0; i < t->nv; i++)
-		l_tmp[i] = t->v[i].l_from;
-	}
+		v->l_from = tick_add(v->l_from, v->e);
 
-	t->len = 0.0;
-	for (i = 0; i < t->nv; i++) {
-		if (t->v[i].l_from > t->len)
-			t->len = t->v[i].l_from;
+		if (v->l_from > t->len)
+			t->len = v->l_from;
 	}
 
-	free(l_tmp);
 	return 0;
 }
 
+/* the edge reaches the adjacency arrays at the next task_update() */
 int task_add_edge(struct task *t, int from, int to)
 {
-	struct vert *src, *dst; 
-	struct _vert *_src, *_dst;
+	int *el;
 
 	if (!t || !t->v)
 		return 1;
@@ -828,30 +867,102 @@ int task_add_edge(struct task *t, int from, int to)
 	if (to < 0 || to >= t->nv)
 		return 1;
 
-	_src = (struct _vert *)malloc(sizeof(struct _vert));
-	if (!_src)
-		return 1;
+	if (t->nel + 2 > t->elcap) {
+		el = (int *)realloc(t->el, 2 * (t->nel + 2) * sizeof(int));
+		if (!el)
+			return 1;
+		t->el = el;
+		t->elcap = 2 * (t->nel + 2);
+	}
+
+	t->el[t->nel++] = from;
+	t->el[t->nel++] = to;
+
+	t->dirty |= DIRTY_GRAPH;
+	return 0;
+}
 
-	_dst = (struct _vert *)malloc(sizeof(struct _vert));
-	if (!_dst) {
-		free(_src);
+/*
+ * Rebuild the forward and reverse CSR arrays, in one block, from the
+ * current ones plus the edges added since: each list keeps the order
+ * in which its edges were added.
+ */
+int task_csr(struct task *t)
+{
+	int ne = t->ne + t->nel / 2, nv = t->nv, *arena, i, k;
+	int *so, *sa, *po, *pa, *sc, *pc;
+
+	if (!t->nel && t->succ_off)
+		return 0;
+
+	arena = (int *)malloc((2 * (size_t)(nv + 1) + 2 * (size_t)ne) *
+			      sizeof(int));
+	sc = (int *)malloc(2 * (size_t)nv * sizeof(int));
+	if (!arena || !sc) {
+		free(arena);
+		free(sc);
 		return 1;
 	}
+	pc = sc + nv;
+
+	so = arena;
+	po = so + nv + 1;
+	sa = po + nv + 1;
+	pa = sa + ne;
+
+	for (i = 0; i < nv; i++) {
+		sc[i] = t->succ_off ? t->succ_off[i + 1] - t->succ_off[i] : 0;
+		pc[i] = t->pred_off ? t->pred_off[i + 1] - t->pred_off[i] : 0;
+	}
+
+	for (k = 0; k < t->nel; k += 2) {
+		sc[t->el[k]]++;
+		pc[t->el[k + 1]]++;
+	}
+
+	so[0] = 0;
+	po[0] = 0;
+	for (i = 0; i < nv; i++) {
+		so[i + 1] = so[i] + sc[i];
+		po[i + 1] = po[i] + pc[i];
+	}
+
+	for (i = 0; i < nv; i++) {
+		sc[i] = so[i];
+		pc[i] = po[i];
+		if (!t->succ_off)
+			continue;
+
+		for (k = t->succ_off[i]; k < t->succ_off[i + 1]; k++)
+			sa[sc[i]++] = t->succ[k];
+		for (k = t->pred_off[i]; k < t->pred_off[i + 1]; k++)
+			pa[pc[i]++] = t->pred[k];
+	}
 
-	_src->id = from;
-	_dst->id = to;
-	src = &t->v[from];
-	dst = &t->v[to];
+	for (k = 0; k < t->nel; k += 2) {
+		sa[sc[t->el[k]]++] = t->el[k + 1];
+		pa[pc[t->el[k + 1]]++] = t->el[k];
+	}
+
+	free(sc);
+	free(t->arena);
+	free(t->el);
 
-	list_add(&dst->pred, &_src->lnode);
-	list_add(&src->succ, &_dst->lnode);
+	t->arena = arena;
+	t->succ_off = so;
+	t->succ = sa;
+	t->pred_off = po;
+	t->pred = pa;
+	t->ne = ne;
 
-	task_length(t);
+	t->el = NULL;
+	t->nel = 0;
+	t->elcap = 0;
 
 	return 0;
 }
 
-int task_set_wcet(struct task *t, int i, double e)
+int task_set_wcet(struct task *t, int i, tick_t e)
 {
 	if (!t || !t->v)
 		return 1;
@@ -859,52 +970,295 @@ int task_set_wcet(struct task *t, int i, double e)
 	if (i < 0 || i >= t->nv)
 		return 1;
 
-	if (e <= 0)
+	if (e <= 0 || e > TICK_MAX)
 		return 1;
 
 	t->v[i].e = e;
 
-	task_volume(t);
-	task_length(t);
+	t->dirty |= DIRTY_WCET;
 	return 0;
 }
 
-int task_reachable(struct task *t, struct vert *s, struct vert *d)
+int task_set_prio(struct task *t, int i, int prio)
 {
-	struct list_head l;
-	struct _vert _va[t->nv];
-	int visit[t->nv], i;
-
-	if (s->id == d->id)
+	if (!t || !t->v)
 		return 1;
 
-	list_init(&l);
+	if (i < 0 || i >= t->nv)
+		return 1;
 
-	for (i = 0; i < t->nv; i++) {
-		_va[i].id = i;
-		visit[i] = 0;
-	}
+	if (prio < PRIO_MIN || prio > PRIO_MAX)
+		return 1;
 
-	visit[s->id] = 1;
-	list_add(&l, &_va[s->id].lnode);
+	t->v[i].prio = prio;
 
-	while (!list_empty(&l)) {
-		struct _vert *_v, *_it;
+	t->dirty |= DIRTY_SCHED;
+	return 0;
+}
 
-		_v = list_first_entry(&l, struct _vert, lnode);
-		list_del(&l, &_v->lnode);
+int task_set_node(struct task *t, int i, struct cl_node *n)
+{
+	if (!t || !t->v)
+		return 1;
 
-		list_for_each_entry(_it, &t->v[_v->id].succ, lnode) {
-			if (_it->id == d->id)
-				return 1;
+	if (i < 0 || i >= t->nv)
+		return 1;
+
+	if (!n || (n->type == CPUNODE && n->cpus < 1))
+		return 1;
+
+	t->v[i].n = n;
+
+	t->dirty |= DIRTY_SCHED;
+	return 0;
+}
+
+int task_sort(struct task *t)
+{
+	int *deg, head, tail, i;
+
+	if (!t || !t->v)
+		return 1;
+
+	t->topo = (int *)malloc(t->nv * sizeof(int));
+	t->rank = (int *)malloc(t->nv * sizeof(int));
+	deg = (int *)malloc(t->nv * sizeof(int));
+	if (!t->topo || !t->rank || !deg) {
+		free(deg);
+		return 1;
+	}
+
+	tail = 0;
+	for (i = 0; i < t->nv; i++) {
+		deg[i] = t->pred_off[i + 1] - t->pred_off[i];
+		if (!deg[i])
+			t->topo[tail++] = i;
+	}
+
+	for (head = 0; head < tail; head++) {
+		int v = t->topo[head], k;
+
+		t->rank[v] = head;
+
+		for (k = t->succ_off[v]; k < t->succ_off[v + 1]; k++) {
+			if (--deg[t->succ[k]] == 0)
+				t->topo[tail++] = t->succ[k];
+		}
+	}
+
+	free(deg);
+
+	/* a cycle leaves some vertex with predecessors never sorted */
+	if (tail != t->nv)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Above this many bytes per task the closure is kept as sorted
+ * intervals of topological ranks instead of one bit per pair.
+ */
+#define REACH_DENSE_MAX	(64 << 20)
 
-			if (!visit[_it->id]) {
-				visit[_it->id] = 1;
-				list_add(&l, &_va[_it->id].lnode);
+/* SCHED_REACH_DENSE_MAX in the environment overrides it, for testing */
+size_t reach_dense_max = REACH_DENSE_MAX;
+
+int interval_cmp(const void *a, const void *b)
+{
+	const int *ia = a, *ib = b;
+
+	return (ia[0] > ib[0]) - (ia[0] < ib[0]);
+}
+
+int task_closure_dense(struct task *t)
+{
+	int i, k;
+
+	t->rw = (t->nv + 63) / 64;
+	t->reach = (uint64_t *)calloc((size_t)t->nv * t->rw,
+				      sizeof(uint64_t));
+	if (!t->reach)
+		return 1;
+
+	for (i = t->nv - 1; i >= 0; i--) {
+		int v = t->topo[i];
+		uint64_t *row = &t->reach[(size_t)v * t->rw];
+		int j;
+
+		for (j = t->succ_off[v]; j < t->succ_off[v + 1]; j++) {
+			int s = t->succ[j];
+			uint64_t *srow = &t->reach[(size_t)s * t->rw];
+
+			row[s / 64] |= 1ULL << (s % 64);
+			for (k = 0; k < t->rw; k++)
+				row[k] |= srow[k];
+		}
+	}
+
+	return 0;
+}
+
+int task_closure_compact(struct task *t)
+{
+	int *tmp = NULL, *p, ntmp, cap = 0, len = 0, size = 0, i, k;
+
+	t->ri_off = (int *)malloc(2 * t->nv * sizeof(int));
+	if (!t->ri_off)
+		return 1;
+
+	/*
+	 * Rows are built in reverse topological order, so successors are
+	 * always complete; row r spans ri[ri_off[2r] .. ri_off[2r + 1]).
+	 */
+	for (i = t->nv - 1; i >= 0; i--) {
+		int v = t->topo[i], j;
+
+		ntmp = 0;
+		for (j = t->succ_off[v]; j < t->succ_off[v + 1]; j++) {
+			int r = t->rank[t->succ[j]];
+			int n = 2 + t->ri_off[2 * r + 1] - t->ri_off[2 * r];
+
+			if (ntmp + n > cap) {
+				cap = 2 * (ntmp + n);
+				p = (int *)realloc(tmp, cap * sizeof(int));
+				if (!p)
+					goto err;
+				tmp = p;
+			}
+
+			tmp[ntmp++] = r;
+			tmp[ntmp++] = r;
+			if (n > 2)
+				memcpy(&tmp[ntmp], &t->ri[t->ri_off[2 * r]],
+				       (n - 2) * sizeof(int));
+			ntmp += n - 2;
+		}
+
+		sort(tmp, ntmp / 2, 2 * sizeof(int), interval_cmp);
+
+		t->ri_off[2 * i] = len;
+		for (k = 0; k < ntmp; k += 2) {
+			if (len > t->ri_off[2 * i] &&
+			    tmp[k] <= t->ri[len - 1] + 1) {
+				if (tmp[k + 1] > t->ri[len - 1])
+					t->ri[len - 1] = tmp[k + 1];
+				continue;
+			}
+
+			if (len + 2 > size) {
+				size = 2 * (len + 2);
+				p = (int *)realloc(t->ri, size * sizeof(int));
+				if (!p)
+					goto err;
+				t->ri = p;
 			}
+
+			t->ri[len++] = tmp[k];
+			t->ri[len++] = tmp[k + 1];
 		}
+		t->ri_off[2 * i + 1] = len;
+	}
+
+	free(tmp);
+	return 0;
+
+err:
+	free(tmp);
+	free(t->ri);
+	free(t->ri_off);
+	t->ri = NULL;
+	t->ri_off = NULL;
+	return 1;
+}
+
+void task_release(struct task *t)
+{
+	if (!t->mapped) {
+		free(t->topo);
+		free(t->rank);
+		free(t->reach);
+		free(t->ri_off);
+		free(t->ri);
+	}
+
+	t->topo = NULL;
+	t->rank = NULL;
+	t->reach = NULL;
+	t->ri_off = NULL;
+	t->ri = NULL;
+	t->mapped = 0;
+}
+
+int task_closure(struct task *t)
+{
+	if (!t || !t->v)
+		return 1;
+
+	task_release(t);
+
+	if (task_sort(t))
+		return 1;
+
+	if ((size_t)t->nv * ((t->nv + 63) / 64) * sizeof(uint64_t)
+	    <= reach_dense_max)
+		return task_closure_dense(t);
+
+	return task_closure_compact(t);
+}
+
+int task_reachable(struct task *t, struct vert *s, struct vert *d)
+{
+	int lo, hi, end, r;
+
+	t->nreach++;
+
+	if (s->id == d->id)
+		return 1;
+
+	if (t->reach)
+		return (t->reach[(size_t)s->id * t->rw + d->id / 64]
+			>> (d->id % 64)) & 1;
+
+	r = t->rank[d->id];
+	end = t->ri_off[2 * t->rank[s->id] + 1] / 2;
+	lo = t->ri_off[2 * t->rank[s->id]] / 2;
+	hi = end;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (t->ri[2 * mid + 1] < r)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo < end && t->ri[2 * lo] <= r;
+}
+
+int task_update(struct task *t)
+{
+	struct phase_clock c;
+
+	if (!t || !t->v)
+		return 1;
+
+	if (t->dirty & DIRTY_GRAPH) {
+		phase_start(&c);
+		if (task_csr(t) || task_closure(t))
+			return 1;
+		phase_stop(&c, &t->closure);
+	}
+
+	if (t->dirty & (DIRTY_GRAPH | DIRTY_WCET)) {
+		phase_start(&c);
+		task_volume(t);
+		task_length(t);
+		phase_stop(&c, &t->length);
 	}
-	
+
+	t->dirty = 0;
 	return 0;
 }
 
@@ -918,14 +1272,16 @@ int task_print(struct task *t)
 
 	snprintf(id, 256, "TASK \"%s\"[%d]:", t->name, t->id);
 
-	printf("%s   # of vertices = %d,  D = %.0f,  T = %.0f\n\n",
-		id, t->nv, t->d, t->p);
+	printf("%s   # of vertices = %d,  D = %.*f,  T = %.*f\n\n",
+		id, t->nv, tick_prec, tick_unit(t->d), tick_prec,
+		tick_unit(t->p));
 
 	for (i = 0; i < t->nv; i++)
 		vert_print(&t->v[i]);
 
-	printf("  len = %.0f,  vol = %.0f,  util. = %.2f\n\n",
-		t->len, t->vol, t->u);
+	printf("  len = %.*f,  vol = %.*f,  util. = %.2f\n\n",
+		tick_prec, tick_unit(t->len), tick_prec, tick_unit(t->vol),
+		t->u);
 
 	return 0;
 }
@@ -940,8 +1296,9 @@ int task_stat(struct task *t)
 
 	snprintf(id, 10, "TASK %d", t->id);
 
-	printf("\n%10s:  resp.time = %.0f,  tardiness = %.0f (D = %.0f)\n\n",
-		id, t->resp, t->tard, t->d);
+	printf("\n%10s:  resp.time = %.*f,  tardiness = %.*f (D = %.*f)\n\n",
+		id, tick_prec, tick_unit(t->resp), tick_prec,
+		tick_unit(t->tard), tick_prec, tick_unit(t->d));
 
 	printf("               vertex     resp.time     tardiness     "
 		"dead.miss\n");
@@ -952,23 +1309,60 @@ int task_stat(struct task *t)
 	return 0;
 }
 
-int task_finalize(struct task *t)
+void task_move(struct task *dst, struct task *src)
 {
 	int i;
 
-	if (!t || !t->v)
+	*dst = *src;
+
+	if (list_empty(&src->nodes)) {
+		list_init(&dst->nodes);
+	} else {
+		dst->nodes.next->prev = &dst->nodes;
+		dst->nodes.prev->next = &dst->nodes;
+	}
+
+	for (i = 0; i < dst->nv; i++)
+		dst->v[i].t = dst;
+}
+
+void task_edges_free(struct task *t)
+{
+	free(t->arena);
+	free(t->el);
+
+	t->succ_off = NULL;
+	t->succ = NULL;
+	t->pred_off = NULL;
+	t->pred = NULL;
+	t->ne = 0;
+	t->arena = NULL;
+
+	t->el = NULL;
+	t->nel = 0;
+	t->elcap = 0;
+}
+
+int task_finalize(struct task *t)
+{
+	if (!t)
 		return 1;
 
-	for (i = 0; i < t->nv; i++) {
-		struct _vert *_v;
+	task_release(t);
+	task_edges_free(t);
 
-		list_for_each_entry(_v, &t->v[i].pred, lnode) 
-			free(_v);
+	while (!list_empty(&t->nodes)) {
+		struct cl_node *n = list_first_entry(&t->nodes,
+						     struct cl_node, lnode);
 
-		list_for_each_entry(_v, &t->v[i].succ, lnode) 
-			free(_v);
+		list_del(&t->nodes, &n->lnode);
+		free(n->iv);
+		if (!t->nbuf)
+			free(n);
 	}
-	
+
+	free(t->nbuf);
+	t->nbuf = NULL;
 	free(t->v);
 	return 0;
 }
@@ -980,21 +1374,91 @@ int taskset_init(struct taskset *ts, int nt)
 	if (!ts || nt <= 0)
 		return 1;
 
-	srand(time(NULL));
-
 	ts->t = (struct task *)malloc(nt * sizeof(struct task));
 	if (!ts->t)
 		return 1;
 
 	for (i = 0; i < nt; i++) {
 		ts->t[i].id = i;
-		memset(ts->t[i].name, 0, 256);
+		ts->t[i].name = "";
+
+		ts->t[i].d = 0;
+		ts->t[i].p = 0;
 
-		ts->t[i].d = 0.0;
-		ts->t[i].p = 0.0;
+		memset(&ts->t[i].closure, 0, sizeof(struct phase));
+		memset(&ts->t[i].length, 0, sizeof(struct phase));
+		ts->t[i].nreach = 0;
+
+		list_init(&ts->t[i].nodes);
+		ts->t[i].nbuf = NULL;
 	}
 
 	ts->nt = nt;
+	ts->u = 0.0;
+	ts->dirty = DIRTY_GRAPH | DIRTY_WCET;
+	ts->n = NULL;
+	ts->nn = 0;
+	ts->v = NULL;
+	ts->nv = 0;
+	ts->he = NULL;
+	ts->hp = NULL;
+	ts->hy = NULL;
+	ts->fe = NULL;
+	ts->fp = NULL;
+	ts->fy = NULL;
+	ts->vec = 0;
+	ts->nth = 1;
+	ts->solver = SOLVER_SWEEP;
+	ts->rounds = XI;
+	ts->exact = 0;
+	ts->verdict = 0;
+	ts->bound = 0;
+	ts->miss = 0;
+	ts->ystart = 0;
+	ts->fixed = 0;
+	ts->capped = 0;
+	ts->by = BY_RTA;
+	ts->byt = NULL;
+	ts->byn = NULL;
+	ts->nr = 0;
+	ts->nupd = NULL;
+	ts->warm = NULL;
+	ts->nwarm = 0;
+	ts->traj = NULL;
+	ts->map = NULL;
+	ts->maplen = 0;
+	memset(&ts->names, 0, sizeof(ts->names));
+	memset(&ts->st, 0, sizeof(ts->st));
+	return 0;
+}
+
+int taskset_update(struct taskset *ts)
+{
+	unsigned int dirty = 0;
+	int i;
+
+	if (!ts || !ts->t)
+		return 1;
+
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		if (!t->dirty)
+			continue;
+
+		dirty |= t->dirty;
+		if (task_update(t))
+			return 1;
+	}
+
+	if (!dirty)
+		return 0;
+
+	ts->u = 0.0;
+	for (i = 0; i < ts->nt; i++)
+		ts->u += ts->t[i].u;
+
+	ts->dirty |= dirty;
 	return 0;
 }
 
@@ -1054,474 +1518,1013 @@ int taskset_stat(struct taskset *ts)
 	return 0;
 }
 
-xmlNode *xml_find_child(xmlNode *root, const char *name)
-{
-	xmlNode *node = root->children;
-
-	while (node) {
-		if (strcmp(node->name, name) == 0)
-			return node;
-
-		node = node->next;
-	}
+/* element kinds tracked by the loader, by depth */
+#define XML_SKIP	0
+#define XML_ROOT	1
+#define XML_APP		2	/* application				*/
+#define XML_SOFT	3	/* softwareModel			*/
+#define XML_PROG	4	/* program				*/
+#define XML_STREAM	5	/* requestResponseStream		*/
+#define XML_SSPEC	6	/* rtSpecification of a stream		*/
+#define XML_SCHED	7	/* schedModel				*/
+#define XML_SNODE	8	/* schedNode				*/
+#define XML_BEHAV	9	/* behaviorModel			*/
+#define XML_BSPEC	10	/* behaviorSpecification		*/
+#define XML_CHUNK	11	/* chunk				*/
+#define XML_CSPEC	12	/* rtSpecification of a chunk		*/
+
+/* first-of-a-kind children already seen, reset when the parent opens */
+#define SEEN_SOFT	(1 << 0)
+#define SEEN_SCHED	(1 << 1)
+#define SEEN_BEHAV	(1 << 2)
+#define SEEN_STREAM	(1 << 3)
+#define SEEN_SSPEC	(1 << 4)
+#define SEEN_RELDL	(1 << 5)
+#define SEEN_OCC	(1 << 6)
+#define SEEN_CSPEC	(1 << 7)
+#define SEEN_STREAM_DONE (1 << 8)
+
+#define XML_DEPTH	16
+/*
+ * A name is a chunk id in the behaviorSpecification and a schedNode
+ * name in the application whose generation is recorded; the first
+ * definition in the scope wins.
+ */
+struct xml_sym {
+	int vgen;		/* bspec where it names a chunk		*/
+	int v;			/* that chunk				*/
+	int ngen;		/* application where it names a node	*/
+	struct cl_node *n;	/* that node				*/
+};
 
-	return NULL;
-}
+struct xml_loader {
+	xmlTextReaderPtr r;
+	int ctx[XML_DEPTH];	/* element kind at each open depth	*/
+	unsigned int seen;	/* SEEN_* flags				*/
+
+	struct task **t;	/* applications parsed so far		*/
+	int nt;
+	struct task *cur;	/* application being parsed		*/
+	int vcap;		/* vertices allocated in cur->v		*/
+	struct cl_node *n;	/* schedNode being parsed		*/
+
+	struct strtab names;	/* every name seen, then the taskset's	*/
+	struct xml_sym *sym;	/* what each name stands for, by id	*/
+	int symcap;
+	int vgen, ngen;		/* current bspec and application	*/
+
+	int *snode;		/* per vertex, id of schedNode name	*/
+	int *succ;		/* (vertex, id of successor name)	*/
+	int nsucc, succcap;
+};
 
-int xml_parse_stream_specification(struct task *t, xmlNode *root)
+int xml_intern(struct xml_loader *xl, const char *name)
 {
-	xmlNode *node;
-	xmlAttr *attr;
+	int id = strtab_intern(&xl->names, name), cap;
+	struct xml_sym *sym;
 
-	node = xml_find_child(root, "relDl");
-	if (!node)
-		return 1;
-
-	t->d = atoi(xmlNodeGetContent(node));
-
-	node = xml_find_child(root, "occKind");
-	if (!node)
-		return 1;
+	if (id < 0 || id < xl->symcap)
+		return id;
 
-	attr = node->properties;
-	while (attr) {
-		if (strcmp(attr->name, "period") == 0) {
-			t->p = atoi(xmlNodeGetContent(attr->children));
-			break;
-		}
+	cap = 2 * xl->symcap > id + 1 ? 2 * xl->symcap : id + 1;
+	sym = (struct xml_sym *)realloc(xl->sym, cap * sizeof(struct xml_sym));
+	if (!sym)
+		return -1;
+	xl->sym = sym;
 
-		attr = attr->next;
-	}
+	memset(&xl->sym[xl->symcap], 0,
+	       (cap - xl->symcap) * sizeof(struct xml_sym));
+	xl->symcap = cap;
 
-	return 0;
+	return id;
 }
 
-int xml_parse_stream(struct task *t, xmlNode *root)
+char *xml_attr(struct xml_loader *xl, const char *name)
 {
-	xmlNode *node = xml_find_child(root, "rtSpecification");
+	return (char *)xmlTextReaderGetAttribute(xl->r, (xmlChar *)name);
+}
 
-	if (!node)
-		return 1;
+int xml_free_verts(struct task *t)
+{
+	task_edges_free(t);
 
-	if (xml_parse_stream_specification(t, node))
-		return 1;
+	free(t->v);
+	t->v = NULL;
+	t->nv = 0;
 
 	return 0;
 }
 
-int xml_parse_program(struct task *t, xmlNode *root)
+int xml_start_app(struct xml_loader *xl)
 {
-	xmlNode *node = xml_find_child(root, "requestResponseStream");
+	struct task **tmp;
+	char *name;
+	int id;
 
-	if (!node)
-		return 0;
+	tmp = (struct task **)realloc(xl->t,
+				      (xl->nt + 1) * sizeof(struct task *));
+	if (!tmp)
+		return 1;
+	xl->t = tmp;
 
-	if (xml_parse_stream(t, node))
+	xl->cur = (struct task *)calloc(1, sizeof(struct task));
+	if (!xl->cur)
 		return 1;
+	xl->t[xl->nt++] = xl->cur;
+
+	xl->cur->name = "";
+	list_init(&xl->cur->nodes);
+	xl->cur->dirty = DIRTY_GRAPH | DIRTY_WCET;
+	xl->vcap = 0;
+	xl->ngen++;
+
+	name = xml_attr(xl, "name");
+	if (name) {
+		id = xml_intern(xl, name);
+		xmlFree(name);
+		if (id < 0)
+			return 1;
+
+		xl->cur->name = xl->names.str[id];
+	}
 
 	return 0;
 }
 
-int xml_parse_software(struct task *t, xmlNode *root)
+int xml_start_node(struct xml_loader *xl)
 {
-	xmlNode *node = root->children;
+	struct cl_node *n;
+	char *name;
+	int id;
 
-	while (node) {
+	n = (struct cl_node *)calloc(1, sizeof(struct cl_node));
+	if (!n)
+		return 1;
 
-		if (strcmp(node->name, "program") == 0) {
-			if (xml_parse_program(t, node))
-				return 1;
+	n->name = "";
+	n->type = -1;
+	n->idx = -1;
+	list_add(&xl->cur->nodes, &n->lnode);
 
-			if (t->d && t->p)
-				break;
-		}
+	name = xml_attr(xl, "name");
+	if (name) {
+		id = xml_intern(xl, name);
+		xmlFree(name);
+		if (id < 0)
+			return 1;
 
-		node = node->next;
+		n->name = xl->names.str[id];
+		if (xl->sym[id].ngen != xl->ngen) {
+			xl->sym[id].ngen = xl->ngen;
+			xl->sym[id].n = n;
+		}
 	}
 
+	xl->n = n;
+
 	return 0;
 }
 
-int xml_count_verts(struct task *t, xmlNode *root)
+int xml_start_chunk(struct xml_loader *xl)
 {
-	xmlNode *node = root->children;
+	struct task *t = xl->cur;
+	struct vert *v;
+	char *attr;
+	int id, cap, *snode;
 
-	t->nv = 0;
+	if (t->nv == xl->vcap) {
+		cap = xl->vcap ? 2 * xl->vcap : 16;
 
-	while (node) {
-		if (strcmp(node->name, "chunk") == 0)
-			t->nv++;
+		v = (struct vert *)realloc(t->v, cap * sizeof(struct vert));
+		if (!v)
+			return 1;
+		t->v = v;
 
-		node = node->next;
+		snode = (int *)realloc(xl->snode, cap * sizeof(int));
+		if (!snode)
+			return 1;
+		xl->snode = snode;
+		xl->vcap = cap;
 	}
 
-	return 0;
-}
-
-int xml_parse_vert_specification(struct task *t, int i, xmlNode *root)
-{
-	xmlNode *node = root->children;
-
-	while (node) {
-		xmlAttr *attr = node->properties;
-
-		while (attr) {
-			if (strcmp(attr->name, "worst") == 0) {
-				if (task_set_wcet(t, i, atoi(
-				     xmlNodeGetContent(attr->children))))
-					return 1;
-			}
+	v = &t->v[t->nv];
+	vert_init(v, t, t->nv);
+	xl->snode[t->nv] = -1;
+	t->nv++;
 
-			if (strcmp(attr->name, "prob") == 0)
-				t->v[i].prob = atof(
-				     xmlNodeGetContent(attr->children));
+	attr = xml_attr(xl, "id");
+	if (attr) {
+		id = xml_intern(xl, attr);
+		xmlFree(attr);
+		if (id < 0)
+			return 1;
 
-			attr = attr->next;
+		v->name = xl->names.str[id];
+		if (xl->sym[id].vgen != xl->vgen) {
+			xl->sym[id].vgen = xl->vgen;
+			xl->sym[id].v = v->id;
 		}
+	}
 
-		node = node->next;
+	attr = xml_attr(xl, "schedNode");
+	if (attr) {
+		xl->snode[v->id] = xml_intern(xl, attr);
+		xmlFree(attr);
+		if (xl->snode[v->id] < 0)
+			return 1;
 	}
 
 	return 0;
 }
 
-int xml_parse_vert(struct task *t, int i, xmlNode *root)
+int xml_start_succ(struct xml_loader *xl)
 {
-	xmlAttr *attr = root->properties;
-	xmlNode *node;
-
-	while (attr) {
-
-		if (strcmp(attr->name, "id") == 0)
-			strcpy(t->v[i].name,
-			       xmlNodeGetContent(attr->children));
-
-		if (strcmp(attr->name, "schedNode") == 0) {
-			struct cl_node *n;
-
-			list_for_each_entry(n, &nodes, lnode) {
-				if (strcmp(n->name, xmlNodeGetContent(
-						attr->children)) == 0) {
-					t->v[i].n = n;
-					break;
-				}
-			}
-		}
+	char *name;
+	int id, *tmp;
 
-		attr = attr->next;
-	}
+	name = xml_attr(xl, "id");
+	if (!name)
+		return 0;
 
-	node = xml_find_child(root, "rtSpecification");
-	if (!node)
+	id = xml_intern(xl, name);
+	xmlFree(name);
+	if (id < 0)
 		return 1;
 
-	attr = node->properties;
-	while (attr) {
-		if (strcmp(attr->name, "priority") == 0)
-			t->v[i].prio = atoi(
-					xmlNodeGetContent(attr->children));
-
-		attr = attr->next;
+	if (xl->nsucc + 2 > xl->succcap) {
+		tmp = (int *)realloc(xl->succ,
+				     2 * (xl->nsucc + 2) * sizeof(int));
+		if (!tmp)
+			return 1;
+		xl->succ = tmp;
+		xl->succcap = 2 * (xl->nsucc + 2);
 	}
 
-	if (xml_parse_vert_specification(t, i, node))
-		return 1;
+	xl->succ[xl->nsucc++] = xl->cur->nv - 1;
+	xl->succ[xl->nsucc++] = id;
 
 	return 0;
 }
 
-int xml_parse_verts(struct task *t, xmlNode *root)
+int xml_start(struct xml_loader *xl)
 {
-	xmlNode *node = root->children;
-	int i = 0;
+	const char *name = (const char *)xmlTextReaderConstLocalName(xl->r);
+	int depth = xmlTextReaderDepth(xl->r);
+	int parent, kind = XML_SKIP;
+	struct task *t = xl->cur;
+	char *attr;
 
-	rb_tree_init(&verts);
+	if (depth >= XML_DEPTH)
+		return 0;
 
-	while (node) {
+	parent = depth ? xl->ctx[depth - 1] : XML_ROOT;
 
-		if (strcmp(node->name, "chunk") == 0) {
-			if (xml_parse_vert(t, i, node))
+	if (depth == 0) {
+		kind = XML_ROOT;
+	} else if (parent == XML_ROOT) {
+		if (strcmp(name, "application") == 0) {
+			if (xml_start_app(xl))
 				return 1;
 
-			RB_CLEAR_NODE(&t->v[i].node);
-			if (verts_insert(&verts, &t->v[i]))
+			xl->seen = 0;
+			kind = XML_APP;
+		}
+	} else if (parent == XML_APP) {
+		if (strcmp(name, "softwareModel") == 0 &&
+		    !(xl->seen & SEEN_SOFT)) {
+			xl->seen |= SEEN_SOFT;
+			kind = XML_SOFT;
+		} else if (strcmp(name, "schedModel") == 0 &&
+			   !(xl->seen & SEEN_SCHED)) {
+			xl->seen |= SEEN_SCHED;
+			kind = XML_SCHED;
+		} else if (strcmp(name, "behaviorModel") == 0 &&
+			   !(xl->seen & SEEN_BEHAV)) {
+			xl->seen |= SEEN_BEHAV;
+			kind = XML_BEHAV;
+		}
+	} else if (parent == XML_SOFT) {
+		/* the first program with a complete stream sets D and T */
+		if (strcmp(name, "program") == 0 &&
+		    !(xl->seen & SEEN_STREAM_DONE)) {
+			xl->seen &= ~SEEN_STREAM;
+			kind = XML_PROG;
+		}
+	} else if (parent == XML_PROG) {
+		if (strcmp(name, "requestResponseStream") == 0 &&
+		    !(xl->seen & SEEN_STREAM)) {
+			xl->seen |= SEEN_STREAM;
+			xl->seen &= ~SEEN_SSPEC;
+			kind = XML_STREAM;
+		}
+	} else if (parent == XML_STREAM) {
+		if (strcmp(name, "rtSpecification") == 0 &&
+		    !(xl->seen & SEEN_SSPEC)) {
+			xl->seen |= SEEN_SSPEC;
+			xl->seen &= ~(SEEN_RELDL | SEEN_OCC);
+			kind = XML_SSPEC;
+		}
+	} else if (parent == XML_SSPEC) {
+		if (strcmp(name, "relDl") == 0 && !(xl->seen & SEEN_RELDL)) {
+			xl->seen |= SEEN_RELDL;
+
+			attr = (char *)xmlTextReaderReadString(xl->r);
+			if (!attr || tick_parse(attr, 0, &t->d))
+				t->d = 0;
+			xmlFree(attr);
+		} else if (strcmp(name, "occKind") == 0 &&
+			   !(xl->seen & SEEN_OCC)) {
+			xl->seen |= SEEN_OCC;
+
+			attr = xml_attr(xl, "period");
+			if (attr) {
+				if (tick_parse(attr, 0, &t->p))
+					t->p = 0;
+				xmlFree(attr);
+			}
+		}
+	} else if (parent == XML_SCHED) {
+		if (strcmp(name, "schedNode") == 0) {
+			if (xml_start_node(xl))
 				return 1;
 
-			i++;
+			kind = XML_SNODE;
 		}
+	} else if (parent == XML_SNODE) {
+		/* a disk or net makes it an I/O node, whatever follows */
+		if (xl->n->type == IONODE)
+			;
+		else if (strcmp(name, "cpu") == 0) {
+			xl->n->type = CPUNODE;
+			xl->n->cpus++;
+		} else if (strcmp(name, "disk") == 0 ||
+			   strcmp(name, "net") == 0) {
+			xl->n->type = IONODE;
+		}
+	} else if (parent == XML_BEHAV) {
+		if (strcmp(name, "behaviorSpecification") == 0) {
+			xml_free_verts(t);
+			xl->vcap = 0;
+			xl->nsucc = 0;
+			xl->vgen++;
+
+			kind = XML_BSPEC;
+		}
+	} else if (parent == XML_BSPEC) {
+		if (strcmp(name, "chunk") == 0) {
+			if (xml_start_chunk(xl))
+				return 1;
 
-		node = node->next;
-	}
-
-	return 0;
-}
+			xl->seen &= ~SEEN_CSPEC;
+			kind = XML_CHUNK;
+		}
+	} else if (parent == XML_CHUNK) {
+		if (strcmp(name, "successor") == 0) {
+			if (xml_start_succ(xl))
+				return 1;
+		} else if (strcmp(name, "rtSpecification") == 0 &&
+			   !(xl->seen & SEEN_CSPEC)) {
+			xl->seen |= SEEN_CSPEC;
+
+			attr = xml_attr(xl, "priority");
+			if (attr) {
+				t->v[t->nv - 1].prio = atoi(attr);
+				xmlFree(attr);
+			}
 
-int __xml_parse_succ(struct task *t, int i, xmlNode *root)
-{
-	xmlAttr *attr = root->properties;
+			kind = XML_CSPEC;
+		}
+	} else if (parent == XML_CSPEC) {
+		struct vert *v = &t->v[t->nv - 1];
 
-	while (attr) {
-		if (strcmp(attr->name, "id") == 0) {
-			struct vert *v = verts_search(&verts,
-					xmlNodeGetContent(attr->children));
+		attr = xml_attr(xl, "worst");
+		if (attr) {
+			if (tick_parse(attr, 1, &v->e))
+				v->e = 0;
+			xmlFree(attr);
 
-			if (!v)
+			if (v->e <= 0)
 				return 1;
+		}
 
-			if (task_add_edge(t, i, v->id))
-				return 1;
+		attr = xml_attr(xl, "prob");
+		if (attr) {
+			v->prob = atof(attr);
+			xmlFree(attr);
+		}
+
+		/* missing or out of order, they collapse towards worst */
+		attr = xml_attr(xl, "best");
+		if (attr) {
+			if (tick_parse(attr, 1, &v->best))
+				v->best = 0;
+			xmlFree(attr);
+		}
+
+		attr = xml_attr(xl, "value");
+		if (attr) {
+			if (tick_parse(attr, 1, &v->value))
+				v->value = 0;
+			xmlFree(attr);
 		}
 
-		attr = attr->next;
+		if (v->best < 1 || v->best > v->e)
+			v->best = v->e;
+		if (v->value < v->best || v->value > v->e)
+			v->value = v->e;
 	}
 
+	xl->ctx[depth] = kind;
 	return 0;
 }
 
-int xml_parse_succ(struct task *t, int i, xmlNode *root)
+int xml_end_bspec(struct xml_loader *xl)
 {
-	xmlNode *node = root->children;
+	struct task *t = xl->cur;
+	int i;
 
-	while (node) {
-		if (strcmp(node->name, "successor") == 0) {
-			if (__xml_parse_succ(t, i, node))
-				return 1;
-		}
+	for (i = 0; i < xl->nsucc; i += 2) {
+		struct xml_sym *sym = &xl->sym[xl->succ[i + 1]];
+
+		if (sym->vgen != xl->vgen)
+			return 1;
 
-		node = node->next;
+		if (task_add_edge(t, xl->succ[i], sym->v))
+			return 1;
 	}
 
+	xl->nsucc = 0;
 	return 0;
 }
 
-int xml_parse_succs(struct task *t, xmlNode *root)
+int xml_end_app(struct xml_loader *xl)
 {
-	xmlNode *node = root->children;
-	int i = 0;
+	struct task *t = xl->cur;
+	int i;
 
-	while (node) {
+	if ((xl->seen & (SEEN_SOFT | SEEN_SCHED | SEEN_BEHAV)) !=
+	    (SEEN_SOFT | SEEN_SCHED | SEEN_BEHAV))
+		return 1;
 
-		if (strcmp(node->name, "chunk") == 0) {
-			if (xml_parse_succ(t, i, node))
-				return 1;
+	for (i = 0; i < t->nv; i++) {
+		struct xml_sym *sym;
 
-			i++;
-		}
+		if (xl->snode[i] < 0)
+			continue;
 
-		node = node->next;
+		sym = &xl->sym[xl->snode[i]];
+		if (sym->ngen == xl->ngen)
+			t->v[i].n = sym->n;
 	}
 
+	xl->cur = NULL;
 	return 0;
 }
 
-int xml_parse_behavior(struct task *t, xmlNode *root)
+int xml_end(struct xml_loader *xl)
 {
-	xmlNode *node = root->children;
+	int depth = xmlTextReaderDepth(xl->r);
 
-	while (node) {
+	if (depth >= XML_DEPTH)
+		return 0;
 
-		if (strcmp(node->name, "behaviorSpecification") == 0) {
-			xml_count_verts(t, node);
+	switch (xl->ctx[depth]) {
+	case XML_APP:
+		return xml_end_app(xl);
+	case XML_PROG:
+		if (xl->cur->d && xl->cur->p)
+			xl->seen |= SEEN_STREAM_DONE;
+		break;
+	case XML_STREAM:
+		if (!(xl->seen & SEEN_SSPEC))
+			return 1;
+		break;
+	case XML_SSPEC:
+		if (!(xl->seen & SEEN_RELDL) || !(xl->seen & SEEN_OCC))
+			return 1;
+		break;
+	case XML_BSPEC:
+		return xml_end_bspec(xl);
+	case XML_CHUNK:
+		if (!(xl->seen & SEEN_CSPEC))
+			return 1;
+		break;
+	}
 
-			if (task_init(t, t->nv, t->d, t->p))
-				return 1;
+	return 0;
+}
+
+/*
+ * Single forward pass over the document with the libxml2 reader: only
+ * the current path is kept, names that may refer forward (successor
+ * ids, schedNode names) are resolved when their scope closes.
+ */
+int xml_load(struct xml_loader *xl, const char *file)
+{
+	int ret;
 
-			if (xml_parse_verts(t, node))
+	xl->r = xmlReaderForFile(file, NULL, XML_PARSE_HUGE);
+	if (!xl->r)
+		return 1;
+
+	while ((ret = xmlTextReaderRead(xl->r)) == 1) {
+		switch (xmlTextReaderNodeType(xl->r)) {
+		case XML_READER_TYPE_ELEMENT:
+			if (xml_start(xl))
 				return 1;
 
-			if (xml_parse_succs(t, node))
+			if (xmlTextReaderIsEmptyElement(xl->r) && xml_end(xl))
+				return 1;
+			break;
+		case XML_READER_TYPE_END_ELEMENT:
+			if (xml_end(xl))
 				return 1;
+			break;
 		}
-
-		node = node->next;
 	}
 
-	return 0;
+	return ret != 0;
 }
 
-int xml_node_type(struct cl_node *n, xmlNode *root)
+int xml_validate(struct taskset *ts)
 {
-	xmlNode *node = root->children;
-	
-	n->cpus = 0;
+	int i, j;
 
-	while (node) {
-		if (strcmp(node->name, "cpu") == 0) {
-			n->type = CPUNODE;
-			n->cpus++;
-		}
+	if (ts->nt < 1)
+		return 1;
 
-		if (strcmp(node->name, "disk") == 0 ||
-	            strcmp(node->name, "net") == 0) {
-			n->type = IONODE;
-			break;
-		}
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		if (t->nv < 1)
+			return 1;
+		if (t->d < 1 || t->p < 1 || t->d > TICK_MAX || t->p > TICK_MAX)
+			return 1;
+		if (strcmp(t->name, "") == 0)
+			return 1;
+
+		for (j = 0; j < t->nv; j++) {
+			struct vert *v = &t->v[j];
+
+			if (!v->t || !v->n)
+				return 1;
+			if (v->n->type != CPUNODE && v->n->type != IONODE)
+				return 1;
+			if (v->n->type == CPUNODE && v->n->cpus < 1)
+				return 1;
 
-		node = node->next;
+			if (v->e < 1 || v->e > TICK_MAX)
+				return 1;
+			if (v->prob < 0.0 || v->prob > 1.0)
+				return 1;
+			if (v->best < 1 || v->best > v->value ||
+			    v->value > v->e)
+				return 1;
+			if (v->prio < PRIO_MIN || v->prio > PRIO_MAX)
+				return 1;
+			if (strcmp(v->name, "") == 0)
+				return 1;
+		}
 	}
 
 	return 0;
 }
 
-int xml_parse_node(xmlNode *root)
+int taskset_finalize(struct taskset *ts)
 {
-	xmlAttr *attr = root->properties;
-	struct cl_node *n;
+	int i;
 
-	n = (struct cl_node *)malloc(sizeof(struct cl_node));
-	if (!n)
+	if (!ts || !ts->t)
 		return 1;
-	memset(n->name, 0, 256);
 
-	while (attr) {
-		if (strcmp(attr->name, "name") == 0) {
-			strcpy(n->name, xmlNodeGetContent(attr->children));
-			break;
-		}
+	for (i = 0; i < ts->nt; i++)
+		task_finalize(&ts->t[i]);
 
-		attr = attr->next;
-	}
+	free(ts->n);
+	free(ts->v);
+	free(ts->he);
+	free(ts->hp);
+	free(ts->hy);
+	free(ts->fe);
+	free(ts->fp);
+	free(ts->fy);
+	free(ts->nupd);
+	free(ts->t);
+	strtab_free(&ts->names);
+
+	if (ts->map)
+		munmap(ts->map, ts->maplen);
 
-	xml_node_type(n, root);
-	list_add(&nodes, &n->lnode);
 	return 0;
 }
 
-int xml_parse_hardware(struct task *t, xmlNode *root)
+int taskset_parse(struct taskset *ts, const char *file)
 {
-	xmlNode *node = root->children;
+	struct xml_loader xl;
+	int i, ret = 1;
 
-	list_init(&nodes);
+	memset(&xl, 0, sizeof(xl));
 
-	while (node) {
+	if (xml_load(&xl, file))
+		goto out;
 
-		if (strcmp(node->name, "schedNode") == 0) {
-			if (xml_parse_node(node))
-				return 1;
-		}
+	if (taskset_init(ts, xl.nt))
+		goto out;
 
-		node = node->next;
+	ts->names = xl.names;
+	memset(&xl.names, 0, sizeof(xl.names));
+
+	for (i = 0; i < xl.nt; i++) {
+		task_move(&ts->t[i], xl.t[i]);
+		ts->t[i].id = i;
+
+		free(xl.t[i]);
 	}
+	xl.nt = 0;
 
-	return 0;
+	if (xml_validate(ts) || taskset_update(ts)) {
+		taskset_finalize(ts);
+		goto out;
+	}
+
+	ret = 0;
+out:
+	for (i = 0; i < xl.nt; i++) {
+		task_finalize(xl.t[i]);
+		free(xl.t[i]);
+	}
+
+	if (xl.r)
+		xmlFreeTextReader(xl.r);
+
+	free(xl.t);
+	strtab_free(&xl.names);
+	free(xl.sym);
+	free(xl.snode);
+	free(xl.succ);
+
+	return ret;
 }
 
-int xml_task_parse(struct task *t, xmlNode *root)
+xmlNode *xml_child(xmlNode *parent, xmlNode *from, const char *name)
 {
-	xmlNode *node;
+	xmlNode *n;
 
-	node = xml_find_child(root, "softwareModel");
-	if (!node)
-		return 1;
-	if (xml_parse_software(t, node))
-		return 1;
+	for (n = from ? from->next : parent->children; n; n = n->next) {
+		if (n->type == XML_ELEMENT_NODE &&
+		    strcmp((const char *)n->name, name) == 0)
+			return n;
+	}
 
-	node = xml_find_child(root, "schedModel");
-	if (!node)
-		return 1;
-	if (xml_parse_hardware(t, node))
+	return NULL;
+}
+
+/*
+ * Copy of the XML model the taskset was parsed from, with the priority
+ * and the schedNode of every chunk replaced; elements are matched the
+ * way the loader picks them, so everything else is kept as written.
+ */
+int xml_write_sched(struct taskset *ts, const char *in, const char *out)
+{
+	xmlNode *app = NULL, *bm, *bs, *last, *c, *spec;
+	xmlDoc *doc;
+	char prio[16];
+	int i, j, ret = 1;
+
+	doc = xmlReadFile(in, NULL, XML_PARSE_HUGE);
+	if (!doc)
 		return 1;
 
-	node = xml_find_child(root, "behaviorModel");
-	if (!node)
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		app = xml_child(xmlDocGetRootElement(doc), app, "application");
+		if (!app)
+			goto out;
+
+		bm = xml_child(app, NULL, "behaviorModel");
+		if (!bm)
+			goto out;
+
+		for (bs = last = NULL;
+		     (bs = xml_child(bm, bs, "behaviorSpecification")); )
+			last = bs;
+		if (!last)
+			goto out;
+
+		for (c = NULL, j = 0;
+		     (c = xml_child(last, c, "chunk")); j++) {
+			spec = xml_child(c, NULL, "rtSpecification");
+			if (j >= t->nv || !spec)
+				goto out;
+
+			snprintf(prio, 16, "%d", t->v[j].prio);
+			xmlSetProp(spec, (const xmlChar *)"priority",
+				   (const xmlChar *)prio);
+			xmlSetProp(c, (const xmlChar *)"schedNode",
+				   (const xmlChar *)t->v[j].n->name);
+		}
+
+		if (j != t->nv)
+			goto out;
+	}
+
+	if (xmlSaveFile(out, doc) >= 0)
+		ret = 0;
+out:
+	xmlFreeDoc(doc);
+	return ret;
+}
+
+/*
+ * Compiled model (.rtsb): a parsed and validated taskset with its
+ * derived data, laid out as flat arrays that are used in place once
+ * the file is mapped. All offsets are from the start of the file and
+ * all sections are 8-byte aligned; names are offsets into the string
+ * table. Values are stored in the byte order of the writer.
+ */
+#define RTSB_MAGIC	"RTSB"
+#define RTSB_VERSION	3
+#define RTSB_ORDER	0x01020304
+
+struct rtsb_header {
+	char magic[4];
+	uint32_t version;
+	uint32_t order;		/* RTSB_ORDER as written		*/
+	uint32_t nt;		/* number of tasks			*/
+	uint64_t size;		/* file size				*/
+	uint64_t str;		/* string table				*/
+	uint64_t nstr;		/* bytes in the string table		*/
+	int64_t res;		/* ticks per model time unit		*/
+	double u;		/* utilization				*/
+};
+
+struct rtsb_task {
+	uint64_t name;
+	int32_t nv;		/* number of vertices			*/
+	int32_t nn;		/* number of nodes			*/
+	int32_t ne;		/* number of edges			*/
+	int32_t rw;		/* words per reach row, 0 if compact	*/
+	int64_t nri;		/* ints in ri				*/
+
+	int64_t d, p, vol, len;	/* in ticks				*/
+	double u;
+
+	uint64_t vert;		/* nv struct rtsb_vert			*/
+	uint64_t node;		/* nn struct rtsb_node			*/
+	uint64_t succ_off;	/* nv + 1 ints, into succ		*/
+	uint64_t succ;		/* ne ints, in successor list order	*/
+	uint64_t pred_off;	/* nv + 1 ints, into pred		*/
+	uint64_t pred;		/* ne ints, in predecessor list order	*/
+	uint64_t topo;		/* nv ints				*/
+	uint64_t rank;		/* nv ints				*/
+	uint64_t reach;		/* nv * rw words, if rw			*/
+	uint64_t ri_off;	/* 2 * nv ints, if !rw			*/
+	uint64_t ri;		/* nri ints, if !rw			*/
+};
+
+struct rtsb_vert {
+	uint64_t name;
+	int32_t node;		/* index in the task node table		*/
+	int32_t prio;
+	int64_t e, best, value;	/* in ticks				*/
+	int64_t l_to, l_from;
+	double prob;
+};
+
+struct rtsb_node {
+	uint64_t name;
+	int32_t type;
+	int32_t cpus;
+};
+
+struct rtsb_writer {
+	FILE *f;
+	uint64_t off;		/* current end of file			*/
+
+	char *str;		/* string table being built		*/
+	uint64_t nstr, strcap;
+};
+
+int rtsb_put(struct rtsb_writer *w, const void *buf, size_t len,
+	     uint64_t *off)
+{
+	static const char pad[8];
+
+	if (off)
+		*off = w->off;
+
+	if (len && fwrite(buf, 1, len, w->f) != len)
 		return 1;
-	if (xml_parse_behavior(t, node))
+	w->off += len;
+
+	len = (8 - w->off % 8) % 8;
+	if (len && fwrite(pad, 1, len, w->f) != len)
 		return 1;
+	w->off += len;
 
 	return 0;
 }
 
-int xml_count_tasks(struct taskset *ts, xmlNode *root)
+uint64_t rtsb_str(struct rtsb_writer *w, const char *s)
 {
-	xmlNode *node = root->children;
-
-	ts->nt = 0;
+	uint64_t len = strlen(s) + 1, off = w->nstr;
 
-	while (node) {
-		if (strcmp(node->name, "application") == 0)
-			ts->nt++;
-
-		node = node->next;
+	if (w->nstr + len > w->strcap) {
+		w->strcap = 2 * (w->nstr + len);
+		w->str = (char *)realloc(w->str, w->strcap);
+		if (!w->str)
+			err_exit("ERROR allocating string table\n");
 	}
 
-	return 0;
+	memcpy(&w->str[off], s, len);
+	w->nstr += len;
+
+	return off;
 }
 
-int xml_task_name(struct task *t, xmlNode *root)
+int rtsb_put_task(struct rtsb_writer *w, struct task *t, struct rtsb_task *rt)
 {
-	xmlAttr *attr = root->properties;
+	struct rtsb_vert *rv;
+	struct rtsb_node *rn;
+	struct cl_node *n;
+	int i;
 
-	while (attr) {
-		if (strcmp(attr->name, "name") == 0) {
-			strcpy(t->name, xmlNodeGetContent(attr->children));
-			break;
-		}
+	memset(rt, 0, sizeof(*rt));
+	rt->name = rtsb_str(w, t->name);
+	rt->nv = t->nv;
+	rt->d = t->d;
+	rt->p = t->p;
+	rt->vol = t->vol;
+	rt->len = t->len;
+	rt->u = t->u;
+
+	/* number the nodes for the vertex records */
+	list_for_each_entry(n, &t->nodes, lnode)
+		n->idx = rt->nn++;
+
+	rn = (struct rtsb_node *)calloc(rt->nn + 1, sizeof(*rn));
+	rv = (struct rtsb_vert *)calloc(t->nv, sizeof(*rv));
+	if (!rn || !rv)
+		goto err;
+
+	list_for_each_entry(n, &t->nodes, lnode) {
+		rn[n->idx].name = rtsb_str(w, n->name);
+		rn[n->idx].type = n->type;
+		rn[n->idx].cpus = n->cpus;
+	}
 
-		attr = attr->next;
+	for (i = 0; i < t->nv; i++) {
+		struct vert *v = &t->v[i];
+
+		rv[i].name = rtsb_str(w, v->name);
+		rv[i].node = v->n->idx;
+		rv[i].prio = v->prio;
+		rv[i].e = v->e;
+		rv[i].best = v->best;
+		rv[i].value = v->value;
+		rv[i].prob = v->prob;
+		rv[i].l_to = v->l_to;
+		rv[i].l_from = v->l_from;
+	}
+	rt->ne = t->ne;
+
+	if (rtsb_put(w, rv, t->nv * sizeof(*rv), &rt->vert) ||
+	    rtsb_put(w, rn, rt->nn * sizeof(*rn), &rt->node) ||
+	    rtsb_put(w, t->succ_off, (t->nv + 1) * sizeof(int),
+		     &rt->succ_off) ||
+	    rtsb_put(w, t->succ, t->ne * sizeof(int), &rt->succ) ||
+	    rtsb_put(w, t->pred_off, (t->nv + 1) * sizeof(int),
+		     &rt->pred_off) ||
+	    rtsb_put(w, t->pred, t->ne * sizeof(int), &rt->pred) ||
+	    rtsb_put(w, t->topo, t->nv * sizeof(int), &rt->topo) ||
+	    rtsb_put(w, t->rank, t->nv * sizeof(int), &rt->rank))
+		goto err;
+
+	if (t->reach) {
+		rt->rw = t->rw;
+		if (rtsb_put(w, t->reach,
+			     (size_t)t->nv * t->rw * sizeof(uint64_t),
+			     &rt->reach))
+			goto err;
+	} else {
+		rt->nri = 0;
+		for (i = 0; i < 2 * t->nv; i++)
+			if (t->ri_off[i] > rt->nri)
+				rt->nri = t->ri_off[i];
+
+		if (rtsb_put(w, t->ri_off, 2 * t->nv * sizeof(int),
+			     &rt->ri_off) ||
+		    rtsb_put(w, t->ri, rt->nri * sizeof(int), &rt->ri))
+			goto err;
 	}
 
+	free(rn);
+	free(rv);
 	return 0;
+err:
+	free(rn);
+	free(rv);
+	return 1;
 }
 
-int xml_parse_tasks(struct taskset *ts, xmlNode *root)
+int taskset_write(struct taskset *ts, const char *file)
 {
-	xmlNode *node = root->children;
-	int i = 0;
+	struct rtsb_writer w;
+	struct rtsb_header h;
+	struct rtsb_task *rt;
+	int i, ret = 1;
 
-	while (node) {
-		if (strcmp(node->name, "application") == 0) {
-			xml_task_name(&ts->t[i], node);
+	if (!ts || !ts->t || taskset_update(ts))
+		return 1;
 
-			if (xml_task_parse(&ts->t[i], node))
-				return 1;
+	memset(&w, 0, sizeof(w));
+	memset(&h, 0, sizeof(h));
 
-			i++;
-		}
+	rt = (struct rtsb_task *)calloc(ts->nt, sizeof(*rt));
+	if (!rt)
+		return 1;
 
-		node = node->next;
-	}
+	w.f = fopen(file, "wb");
+	if (!w.f)
+		goto out;
+
+	/* header and task table are rewritten once offsets are known */
+	if (rtsb_put(&w, &h, sizeof(h), NULL) ||
+	    rtsb_put(&w, rt, ts->nt * sizeof(*rt), NULL))
+		goto out;
 
-	ts->u = 0.0;
 	for (i = 0; i < ts->nt; i++)
-		ts->u += ts->t[i].u;
+		if (rtsb_put_task(&w, &ts->t[i], &rt[i]))
+			goto out;
+
+	memcpy(h.magic, RTSB_MAGIC, 4);
+	h.version = RTSB_VERSION;
+	h.order = RTSB_ORDER;
+	h.nt = ts->nt;
+	h.nstr = w.nstr;
+	h.res = tick_res;
+	h.u = ts->u;
+
+	if (rtsb_put(&w, w.str, w.nstr, &h.str))
+		goto out;
+	h.size = w.off;
+
+	if (fseek(w.f, 0, SEEK_SET) ||
+	    fwrite(&h, sizeof(h), 1, w.f) != 1 ||
+	    fwrite(rt, sizeof(*rt), ts->nt, w.f) != (size_t)ts->nt)
+		goto out;
+
+	ret = 0;
+out:
+	if (w.f && fclose(w.f))
+		ret = 1;
+	if (ret && w.f)
+		unlink(file);
+
+	free(w.str);
+	free(rt);
+	return ret;
+}
 
-	return 0;
+/* pointer to a section of n elements, or NULL if it is out of the file */
+const void *rtsb_section(struct taskset *ts, uint64_t off, uint64_t n,
+			 size_t size)
+{
+	if (off % 8 || off > ts->maplen ||
+	    (size && n > (ts->maplen - off) / size))
+		return NULL;
+
+	return (const char *)ts->map + off;
 }
 
-int xml_validate(struct taskset *ts)
+/* names are used in place: they must end within the string table */
+const char *rtsb_name(struct taskset *ts, const struct rtsb_header *h,
+		      uint64_t off)
 {
-	int i, j;
+	const char *s;
 
-	if (ts->nt < 1)
-		return 1;
+	if (off >= h->nstr)
+		return NULL;
 
-	for (i = 0; i < ts->nt; i++) {
-		struct task *t = &ts->t[i];
+	s = (const char *)ts->map + h->str + off;
+	return memchr(s, 0, h->nstr - off) ? s : NULL;
+}
 
-		if (t->nv < 1)
-			return 1;
-		if (t->d < 1.0 || t->p < 1.0)
-			return 1;
-		if (strcmp(t->name, "") == 0)
-			return 1;
+/* the CSR arrays are used in place: check every offset and vertex */
+int rtsb_adj(int nv, const int *off, const int *adj, int ne)
+{
+	int i, k;
 
-		for (j = 0; j < t->nv; j++) {
-			struct vert *v = &t->v[j];
+	if (off[0] != 0 || off[nv] != ne)
+		return 1;
 
-			if (!v->t || !v->n)
-				return 1;
-			if (v->n->type != CPUNODE && v->n->type != IONODE)
-				return 1;
-			if (v->n->type == CPUNODE && v->n->cpus < 1)
-				return 1;
+	for (i = 0; i < nv; i++) {
+		if (off[i + 1] < off[i] || off[i + 1] > ne)
+			return 1;
 
-			if (v->e < 1.0)
-				return 1;
-			if (v->prob < 0.0 || v->prob > 1.0)
-				return 1;
-			if (v->prio < PRIO_MIN || v->prio > PRIO_MAX)
-				return 1;
-			if (strcmp(v->name, "") == 0)
+		for (k = off[i]; k < off[i + 1]; k++) {
+			if (adj[k] < 0 || adj[k] >= nv)
 				return 1;
 		}
 	}
@@ -1529,195 +2532,769 @@ int xml_validate(struct taskset *ts)
 	return 0;
 }
 
-int taskset_parse(struct taskset *ts, const char *file)
+int rtsb_get_task(struct taskset *ts, const struct rtsb_header *h,
+		  const struct rtsb_task *rt, struct task *t)
 {
-	xmlDoc *doc = NULL;
-	xmlNode *root = NULL;
+	const struct rtsb_vert *rv;
+	const struct rtsb_node *rn;
+	struct cl_node *nodes;
+	const char *name;
 	int i;
 
-	LIBXML_TEST_VERSION
-
-	doc = xmlReadFile(file, NULL, 0);
-	if (doc == NULL)
+	if (rt->nv < 1 || rt->nn < 1 || rt->ne < 0 || rt->rw < 0 ||
+	    rt->nri < 0)
 		return 1;
 
-	root = xmlDocGetRootElement(doc);
-
-	xml_count_tasks(ts, root);
-	if (taskset_init(ts, ts->nt))
+	rv = rtsb_section(ts, rt->vert, rt->nv, sizeof(*rv));
+	rn = rtsb_section(ts, rt->node, rt->nn, sizeof(*rn));
+	t->succ_off = (int *)rtsb_section(ts, rt->succ_off, rt->nv + 1,
+					 sizeof(int));
+	t->succ = (int *)rtsb_section(ts, rt->succ, rt->ne, sizeof(int));
+	t->pred_off = (int *)rtsb_section(ts, rt->pred_off, rt->nv + 1,
+					 sizeof(int));
+	t->pred = (int *)rtsb_section(ts, rt->pred, rt->ne, sizeof(int));
+	t->topo = (int *)rtsb_section(ts, rt->topo, rt->nv, sizeof(int));
+	t->rank = (int *)rtsb_section(ts, rt->rank, rt->nv, sizeof(int));
+	name = rtsb_name(ts, h, rt->name);
+	if (!rv || !rn || !t->succ_off || !t->succ || !t->pred_off ||
+	    !t->pred || !t->topo || !t->rank || !name)
 		return 1;
 
-	if (xml_parse_tasks(ts, root))
+	if (rtsb_adj(rt->nv, t->succ_off, t->succ, rt->ne) ||
+	    rtsb_adj(rt->nv, t->pred_off, t->pred, rt->ne))
 		return 1;
+	t->ne = rt->ne;
 
-	if (xml_validate(ts))
-		return 1;
+	if (rt->rw) {
+		if (rt->rw != (rt->nv + 63) / 64)
+			return 1;
 
-	xmlFreeDoc(doc);
-	xmlCleanupParser();
+		t->rw = rt->rw;
+		t->reach = (uint64_t *)rtsb_section(ts, rt->reach,
+						    (uint64_t)rt->nv * rt->rw,
+						    sizeof(uint64_t));
+		if (!t->reach)
+			return 1;
+	} else {
+		t->ri_off = (int *)rtsb_section(ts, rt->ri_off, 2 * rt->nv,
+						sizeof(int));
+		t->ri = (int *)rtsb_section(ts, rt->ri, rt->nri, sizeof(int));
+		if (!t->ri_off || !t->ri)
+			return 1;
 
-	return 0;
-}
+		for (i = 0; i < 2 * rt->nv; i += 2)
+			if (t->ri_off[i] < 0 || t->ri_off[i] % 2 ||
+			    t->ri_off[i + 1] < t->ri_off[i] ||
+			    t->ri_off[i + 1] > rt->nri)
+				return 1;
+	}
 
-int taskset_finalize(struct taskset *ts)
-{
-	int i;
+	for (i = 0; i < rt->nv; i++)
+		if (t->topo[i] < 0 || t->topo[i] >= rt->nv ||
+		    t->rank[i] < 0 || t->rank[i] >= rt->nv)
+			return 1;
 
-	if (!ts || !ts->t)
+	/* rank inverts topo only if both are permutations */
+	for (i = 0; i < rt->nv; i++)
+		if (t->rank[t->topo[i]] != i)
+			return 1;
+
+	/* d and p are checked by xml_validate(), derived times here */
+	if (rt->vol < 0 || rt->vol > TICK_MAX || rt->len < 0 ||
+	    rt->len > TICK_MAX)
 		return 1;
 
-	for (i = 0; i < ts->nt; i++)
-		task_finalize(&ts->t[i]);
+	t->name = name;
+	t->d = rt->d;
+	t->p = rt->p;
+	t->vol = rt->vol;
+	t->len = rt->len;
+	t->u = rt->u;
 
-	free(ts->t);
-	return 0;
-}
+	/* owned by t once in its list, and freed with it */
+	nodes = (struct cl_node *)calloc(rt->nn, sizeof(struct cl_node));
+	if (!nodes)
+		return 1;
+	t->nbuf = nodes;
 
-#define max(a, b)	((a > b) ? a : b)
-#define min(a, b)	((a < b) ? a : b)
+	for (i = 0; i < rt->nn; i++) {
+		name = rtsb_name(ts, h, rn[i].name);
+		if (!name)
+			return 1;
 
-#define XI	16
-#define TARD_TOL	10000000000.0
-int rta(struct taskset *ts, int *sched)
-{
-	int x_schedule, y_update;
-	int i, j, k, l, nu;
+		nodes[i].name = name;
+		nodes[i].type = rn[i].type;
+		nodes[i].cpus = rn[i].cpus;
+		nodes[i].idx = -1;
+		list_add(&t->nodes, &nodes[i].lnode);
+	}
 
-	if (!ts)
+	t->v = (struct vert *)malloc(rt->nv * sizeof(struct vert));
+	if (!t->v)
 		return 1;
+	t->nv = rt->nv;
 
-	for (i = 0; i < ts->nt; i++) {
-		struct task *t = &ts->t[i];
+	for (i = 0; i < t->nv; i++)
+		vert_init(&t->v[i], t, i);
 
-		for (j = 0; j < t->nv; j++) {
-			struct vert *v = &t->v[j];
+	for (i = 0; i < t->nv; i++) {
+		struct vert *v = &t->v[i];
 
-			v->x = v->e;
-			v->y = t->d + 1.0;
-		}
+		name = rtsb_name(ts, h, rv[i].name);
+		if (!name || rv[i].node < 0 || rv[i].node >= rt->nn ||
+		    rv[i].l_to < 0 || rv[i].l_to > TICK_MAX ||
+		    rv[i].l_from < 0 || rv[i].l_from > TICK_MAX)
+			return 1;
+
+		v->name = name;
+		v->n = &nodes[rv[i].node];
+		v->prio = rv[i].prio;
+		v->e = rv[i].e;
+		v->u = (double)v->e / t->p;
+		v->best = rv[i].best;
+		v->value = rv[i].value;
+		v->prob = rv[i].prob;
+		v->l_to = rv[i].l_to;
+		v->l_from = rv[i].l_from;
 	}
 
-	nu = 1;
+	t->dirty = 0;
+	return 0;
+}
 
-next_fixedpoint:
-	x_schedule = 1;
-	y_update = 0;
+int taskset_map(struct taskset *ts, const char *file)
+{
+	const struct rtsb_header *h;
+	const struct rtsb_task *rt;
+	struct stat st;
+	void *map;
+	int fd, i;
+
+	fd = open(file, O_RDONLY);
+	if (fd < 0)
+		return 1;
 
-	for (i = 0; i < ts->nt; i++) {
-		struct task *t = &ts->t[i];
+	if (fstat(fd, &st) || st.st_size < (off_t)sizeof(*h)) {
+		close(fd);
+		return 1;
+	}
 
-		for (j = 0; j < t->nv; j++) {
-			struct vert *v = &t->v[j];
-			double next_x, pred;
-			struct _vert *_v;
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED)
+		return 1;
 
-next_iteration:
-			next_x = 0.0;
+	h = (const struct rtsb_header *)map;
+	if (memcmp(h->magic, RTSB_MAGIC, 4) || h->version != RTSB_VERSION ||
+	    h->order != RTSB_ORDER || h->size != (uint64_t)st.st_size ||
+	    h->res != tick_res ||
+	    h->nt < 1 || h->nt > (st.st_size - sizeof(*h)) / sizeof(*rt) ||
+	    taskset_init(ts, h->nt)) {
+		munmap(map, st.st_size);
+		return 1;
+	}
 
-			if (v->n->type == IONODE)
-				goto IO_operation;
+	ts->map = map;
+	ts->maplen = st.st_size;
+
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
 
-			for (k = 0; k < ts->nt; k++) {
-				struct task *ti = &ts->t[k];
+		t->v = NULL;
+		t->nv = 0;
+		t->topo = NULL;
+		t->rank = NULL;
+		t->reach = NULL;
+		t->ri_off = NULL;
+		t->ri = NULL;
+		t->mapped = 1;
+		t->succ_off = NULL;
+		t->succ = NULL;
+		t->pred_off = NULL;
+		t->pred = NULL;
+		t->ne = 0;
+		t->arena = NULL;
+		t->el = NULL;
+		t->nel = 0;
+		t->elcap = 0;
+	}
 
-				for (l = 0; l < ti->nv; l++) {
-					struct vert *vi = &ti->v[l];
-					double wi;
+	rt = rtsb_section(ts, sizeof(*h), h->nt, sizeof(*rt));
+	if (!rt || !rtsb_section(ts, h->str, h->nstr, 1) || !h->nstr ||
+	    ((const char *)map)[h->str + h->nstr - 1])
+		goto err;
 
-					if (vi->prio < v->prio)
-						continue;
+	for (i = 0; i < ts->nt; i++)
+		if (rtsb_get_task(ts, h, &rt[i], &ts->t[i]))
+			goto err;
 
-					if (vi->n != v->n)
-						continue;
+	if (xml_validate(ts))
+		goto err;
 
-					wi = max(ceil((vi->y + v->x) / ti->p),
-						 0.0);
+	ts->u = h->u;
+	return 0;
+err:
+	taskset_finalize(ts);
+	return 1;
+}
 
-					next_x += wi * vi->e;
+/* a compiled model if it starts with the magic, else an XML file */
+int taskset_load(struct taskset *ts, const char *file)
+{
+	char magic[4];
+	FILE *f;
+	int n;
 
-					if (ti->id == t->id) {
-						if (vi->id != v->id &&
-						    task_reachable(t, v, vi))
-							next_x -= vi->e;
-					}
-				}
-			}
+	f = fopen(file, "rb");
+	if (!f)
+		return 1;
 
-			next_x = floor(next_x / (double)v->n->cpus);
-IO_operation:
-			next_x += v->e;
+	n = fread(magic, 1, 4, f);
+	fclose(f);
 
-			pred = 0.0;
-			list_for_each_entry(_v, &v->pred, lnode) {
-				if (pred < t->v[_v->id].y)
-					pred = t->v[_v->id].y;
-			}
-			next_x += pred;
+	if (n == 4 && memcmp(magic, RTSB_MAGIC, 4) == 0)
+		return taskset_map(ts, file);
 
-			if (next_x > t->d + TARD_TOL - 1.0)
-				next_x = t->d + TARD_TOL;
+	return taskset_parse(ts, file);
+}
 
-			if (next_x > v->x) {
-				v->x = next_x;
-				goto next_iteration;
-			}
+const char *taskset_intern(struct taskset *ts, const char *name)
+{
+	int id = strtab_intern(&ts->names, name);
 
-			if (v->x > t->d)
-				x_schedule &= 0;
+	return id < 0 ? NULL : ts->names.str[id];
+}
 
-			if (v->x < v->y)
-				y_update |= 1;
-		}
-	}
+/* an independent copy of an analysed taskset, for concurrent analyses */
 
-	nu = nu + 1;
-	if ((nu > XI && XI != 0) || !y_update) {
-		if (x_schedule)
-			goto fixedpoint_schedule;
+int taskset_clone(struct taskset *dst, struct taskset *src)
+{
+	struct cl_node **from, **to;
+	int i, j, k, nn;
 
-		*sched = 0;
+	if (!src || !src->t || taskset_init(dst, src->nt))
+		return 1;
 
-		for (i = 0; i < ts->nt; i++) {
-			struct task *t = &ts->t[i];
+	for (i = 0; i < src->nt; i++) {
+		struct task *s = &src->t[i], *t = &dst->t[i];
+		struct cl_node *n;
 
-			t->resp = 0.0;
-			for (j = 0; j < t->nv; j++) {
-				struct vert *v = &t->v[j];
+		if (task_init(t, s->nv, s->d, s->p)) {
+			dst->nt = i;
+			goto err;
+		}
+		t->name = taskset_intern(dst, s->name);
+		if (!t->name) {
+			dst->nt = i + 1;
+			goto err;
+		}
 
-				v->resp = v->x;
-				v->tard = v->resp - t->d;
+		nn = 0;
+		list_for_each_entry(n, &s->nodes, lnode)
+			nn++;
+
+		from = (struct cl_node **)malloc((nn + 1) * sizeof(*from));
+		to = (struct cl_node **)malloc((nn + 1) * sizeof(*to));
+		if (!from || !to)
+			goto err_nodes;
+
+		k = 0;
+		list_for_each_entry(n, &s->nodes, lnode) {
+			from[k] = n;
+			to[k] = (struct cl_node *)calloc(1,
+						sizeof(struct cl_node));
+			if (!to[k])
+				goto err_nodes;
+
+			to[k]->name = taskset_intern(dst, n->name);
+			if (!to[k]->name)
+				goto err_nodes;
+			to[k]->type = n->type;
+			to[k]->cpus = n->cpus;
+			to[k]->idx = -1;
+			list_add(&t->nodes, &to[k++]->lnode);
+		}
 
-				if (v->resp > t->resp) {
-					t->resp = v->resp;
-					t->tard = t->resp - t->d;
-				}
+		for (j = 0; j < s->nv; j++) {
+			struct vert *sv = &s->v[j], *v = &t->v[j];
+
+			v->name = taskset_intern(dst, sv->name);
+			if (!v->name)
+				goto err_nodes;
+			v->e = sv->e;
+			v->best = sv->best;
+			v->value = sv->value;
+			v->prob = sv->prob;
+			v->prio = sv->prio;
+
+			for (k = 0; from[k] != sv->n; k++)
+				;
+			v->n = to[k];
+
+			for (k = s->succ_off[j]; k < s->succ_off[j + 1]; k++) {
+				if (task_add_edge(t, j, s->succ[k]))
+					goto err_nodes;
 			}
 		}
 
-		return 0;
+		free(from);
+		free(to);
 	}
 
-	for (i = 0; i < ts->nt; i++) {
-		struct task *t = &ts->t[i];
+	if (taskset_update(dst))
+		goto err;
 
-		for (j = 0; j < t->nv; j++) {
-			struct vert *v = &t->v[j];
-			double next_x;
+	dst->nth = src->nth;
+	dst->solver = src->solver;
+	dst->rounds = src->rounds;
+	dst->exact = src->exact;
+	return 0;
+err_nodes:
+	free(from);
+	free(to);
+	dst->nt = i + 1;
+err:
+	taskset_finalize(dst);
+	return 1;
+}
 
-			v->y = v->x;
-			v->x = v->e;
+#define max(a, b)	((a > b) ? a : b)
+#define min(a, b)	((a < b) ? a : b)
+
+int vert_prio_cmp(const void *a, const void *b)
+{
+	const struct vert *va = *(struct vert **)a, *vb = *(struct vert **)b;
+
+	if (va->prio != vb->prio)
+		return vb->prio - va->prio;
+	if (va->t->id != vb->t->id)
+		return va->t->id - vb->t->id;
+
+	return va->id - vb->id;
+}
+
+int node_prepare(struct cl_node *n)
+{
+	int j, k;
+
+	sort(n->iv, n->niv, sizeof(struct vert *), vert_prio_cmp);
+
+	for (j = n->niv - 1; j >= 0; j--) {
+		struct vert *v = n->iv[j];
+
+		if (j < n->niv - 1 && n->iv[j + 1]->prio == v->prio)
+			v->ni = n->iv[j + 1]->ni;
+		else
+			v->ni = j + 1;
+
+		v->sub = 0;
+		if (n->type == IONODE) {
+			v->ni = 0;
+			continue;
+		}
+
+		for (k = 0; k < v->ni; k++) {
+			struct vert *vi = n->iv[k];
+
+			if (vi->t == v->t && vi != v &&
+			    task_reachable(v->t, v, vi))
+				v->sub = tick_add(v->sub, vi->e);
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Build the static part of the analysis: for every node the vertices it
+ * hosts sorted by decreasing priority, so that the interferers of a
+ * vertex are the first v->ni entries of v->n->iv, plus the constant
+ * amount of same-task interference each vertex discounts.
+ */
+int rta_prepare(struct taskset *ts)
+{
+	struct cl_node **tmp;
+	int i, j;
+
+	for (i = 0; i < ts->nn; i++) {
+		free(ts->n[i]->iv);
+		ts->n[i]->iv = NULL;
+		ts->n[i]->idx = -1;
+	}
+	ts->nn = 0;
+	ts->nv = 0;
+
+	for (i = 0; i < ts->nt; i++)
+		ts->nv += ts->t[i].nv;
+
+	free(ts->v);
+	free(ts->he);
+	free(ts->hp);
+	free(ts->hy);
+	free(ts->fe);
+	free(ts->fp);
+	free(ts->fy);
+	ts->v = (struct vert **)malloc(ts->nv * sizeof(struct vert *));
+	ts->he = (tick_t *)malloc(ts->nv * sizeof(tick_t));
+	ts->hp = (tick_t *)malloc(ts->nv * sizeof(tick_t));
+	ts->hy = (tick_t *)malloc(ts->nv * sizeof(tick_t));
+	ts->fe = (double *)malloc(ts->nv * sizeof(double));
+	ts->fp = (double *)malloc(ts->nv * sizeof(double));
+	ts->fy = (double *)malloc(ts->nv * sizeof(double));
+	if (!ts->v || !ts->he || !ts->hp || !ts->hy || !ts->fe || !ts->fp ||
+	    !ts->fy)
+		return 1;
+
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		for (j = 0; j < t->nv; j++) {
+			struct cl_node *n = t->v[j].n;
+
+			if (n->idx >= 0) {
+				n->niv++;
+				continue;
+			}
+
+			tmp = (struct cl_node **)realloc(ts->n,
+				(ts->nn + 1) * sizeof(struct cl_node *));
+			if (!tmp)
+				return 1;
+			ts->n = tmp;
+
+			n->idx = ts->nn;
+			n->niv = 1;
+			ts->n[ts->nn++] = n;
+		}
+	}
+
+	for (i = 0; i < ts->nn; i++) {
+		ts->n[i]->iv = (struct vert **)malloc(ts->n[i]->niv *
+						      sizeof(struct vert *));
+		if (!ts->n[i]->iv)
+			return 1;
+
+		ts->n[i]->niv = 0;
+	}
+
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		for (j = 0; j < t->nv; j++)
+			t->v[j].n->iv[t->v[j].n->niv++] = &t->v[j];
+	}
+
+	ts->nv = 0;
+	for (i = 0; i < ts->nn; i++) {
+		node_prepare(ts->n[i]);
+
+		for (j = 0; j < ts->n[i]->niv; j++)
+			ts->v[ts->nv++] = ts->n[i]->iv[j];
+	}
+
+	ts->dirty = 0;
+	return 0;
+}
+
+/*
+ * The outer iteration stops when no X is below its Y any more, or after
+ * ts->rounds rounds (XI unless set with --max-rounds, 0 for no limit);
+ * with ts->exact only when every X equals its Y, a true fixed point.
+ * Trajectories for the slack warm starts keep at most XI rounds.
+ */
+
+/* X at which a vertex of t stops growing: far past any deadline miss */
+tick_t rta_cap(struct task *t)
+{
+	return tick_add(t->d, tick_tol);
+}
+
+/*
+ * Vector kernels for the interference sum, on doubles: with integer
+ * operands below 2^53 the quotient rounds to the right side of every
+ * integer, so ceil() is exact, and so is every product and partial sum
+ * below 2^53; a sum at or above it is only ever compared with 2^53.
+ */
+#define VEC_EXACT	9007199254740992.0	/* 2^53		*/
+
+typedef double (*rta_vsum_fn)(const double *e, const double *p,
+			      const double *y, int n, double x);
+
+rta_vsum_fn rta_vsum;
+pthread_once_t rta_vsum_once = PTHREAD_ONCE_INIT;
+
+#if defined(__x86_64__)
+__attribute__((target("avx2,fma")))
+double rta_vsum_avx2(const double *e, const double *p, const double *y,
+		     int n, double x)
+{
+	__m256d vx = _mm256_set1_pd(x), acc = _mm256_setzero_pd(), j;
+	__m128d lo;
+	double sum;
+	int k;
+
+	for (k = 0; k + 4 <= n; k += 4) {
+		j = _mm256_div_pd(_mm256_add_pd(_mm256_loadu_pd(y + k), vx),
+				  _mm256_loadu_pd(p + k));
+		acc = _mm256_fmadd_pd(_mm256_ceil_pd(j),
+				      _mm256_loadu_pd(e + k), acc);
+	}
+
+	lo = _mm_add_pd(_mm256_castpd256_pd128(acc),
+			_mm256_extractf128_pd(acc, 1));
+	sum = _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));
+
+	for (; k < n; k++)
+		sum += ceil((y[k] + x) / p[k]) * e[k];
+
+	return sum;
+}
+
+__attribute__((target("avx512f")))
+double rta_vsum_avx512(const double *e, const double *p, const double *y,
+		       int n, double x)
+{
+	__m512d vx = _mm512_set1_pd(x), one = _mm512_set1_pd(1.0);
+	__m512d acc = _mm512_setzero_pd(), j;
+	__mmask8 m;
+	int k;
+
+	for (k = 0; k < n; k += 8) {
+		/* past the end: e = 0, and p = 1 keeps the quotient finite */
+		m = n - k >= 8 ? 0xff : (1 << (n - k)) - 1;
+		j = _mm512_div_pd(_mm512_add_pd(_mm512_maskz_loadu_pd(m, y + k),
+						vx),
+				  _mm512_mask_loadu_pd(one, m, p + k));
+		j = _mm512_roundscale_pd(j, _MM_FROUND_TO_POS_INF |
+					    _MM_FROUND_NO_EXC);
+		acc = _mm512_fmadd_pd(j, _mm512_maskz_loadu_pd(m, e + k), acc);
+	}
+
+	return _mm512_reduce_add_pd(acc);
+}
+#endif
+
+/*
+ * The widest kernel the CPU has, or the one SCHED_KERNEL names (scalar,
+ * avx2 or avx512), so that tests can compare them on one machine.
+ */
+void rta_vsum_select(void)
+{
+	const char *k = getenv("SCHED_KERNEL");
+
+#if defined(__x86_64__)
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") &&
+	    (!k || strcmp(k, "avx512") == 0))
+		rta_vsum = rta_vsum_avx512;
+	else if (__builtin_cpu_supports("avx2") &&
+		 __builtin_cpu_supports("fma") &&
+		 (!k || strcmp(k, "avx2") == 0))
+		rta_vsum = rta_vsum_avx2;
+#endif
+	if (k && !rta_vsum && strcmp(k, "scalar") != 0)
+		err_exit("ERROR kernel %s not available\n", k);
+}
+
+/*
+ * Lay out e, period and Y of the vertices of every node contiguously,
+ * in the order of n->iv, so that the interferers of a vertex are a
+ * prefix of its node's slice. Edits that reorder n->iv without a full
+ * rta_prepare() (what-if, slack probes) only need this to be redone.
+ *
+ * The vector kernel is used if the CPU has one and every operand is
+ * exact as a double: Y + X, periods and WCETs below 2^53, and a sum
+ * that reaches 2^53 would take X past its cap anyway.
+ */
+void rta_hot(struct taskset *ts)
+{
+	tick_t cap = 0, big = 0, sub = 0;
+	int i, k, pos = 0, cpus = 1;
+
+	pthread_once(&rta_vsum_once, rta_vsum_select);
+
+	for (i = 0; i < ts->nn; i++) {
+		struct cl_node *n = ts->n[i];
+
+		n->base = pos;
+		for (k = 0; k < n->niv; k++, pos++) {
+			struct vert *v = n->iv[k];
+
+			v->pos = pos;
+			ts->he[pos] = v->e;
+			ts->hp[pos] = v->t->p;
+			ts->hy[pos] = v->y;
+			ts->fe[pos] = v->e;
+			ts->fp[pos] = v->t->p;
+			ts->fy[pos] = v->y;
+
+			cap = max(cap, rta_cap(v->t));
+			big = max(big, max(v->e, v->t->p));
+			sub = max(sub, v->sub);
+			if (n->type == CPUNODE)
+				cpus = max(cpus, n->cpus);
 		}
 	}
 
-	goto next_fixedpoint;
+	ts->vec = rta_vsum && cap < VEC_EXACT / 2 && big < VEC_EXACT &&
+		  sub < VEC_EXACT / 2 &&
+		  cap + 1 < (VEC_EXACT / 2) / cpus;
+}
+
+void rta_set_y(struct taskset *ts, struct vert *v)
+{
+	ts->hy[v->pos] = v->y;
+	ts->fy[v->pos] = v->y;
+}
+
+void rta_vert_init(struct taskset *ts, struct vert *v)
+{
+	v->x = v->e;
+	v->y = ts->ystart ? v->ys : v->t->d + 1;
+	rta_set_y(ts, v);
+
+	v->yc = 1;
+	v->sr = 0;
+	v->upd = 0;
+}
+
+struct rta_count {
+	uint64_t inner;		/* inner iterations			*/
+	uint64_t term;		/* interference terms evaluated		*/
+};
+
+/*
+ * Sum of ceil((Y + x) / p) * e over n interferers, saturated at
+ * TICK_MAX. Y and x are at most TICK_MAX, so only the products and
+ * the sum need checking.
+ */
+tick_t rta_interference(const tick_t *e, const tick_t *p, const tick_t *y,
+			int n, tick_t x)
+{
+	tick_t sum = 0, w;
+	int k;
+
+	for (k = 0; k < n; k++) {
+		if (__builtin_mul_overflow((y[k] + x + p[k] - 1) / p[k], e[k],
+					   &w) || w > TICK_MAX - sum)
+			return TICK_MAX;
+		sum += w;
+	}
+
+	return sum;
+}
+
+/*
+ * Round nu of the outer fixed point for a single vertex: X_v is raised
+ * from e until it is consistent with the Y of its interferers and
+ * predecessors. Returns 1 if the resulting X_v is below Y_v.
+ *
+ * For ts->verdict, an X_v past the deadline in the last round, or from
+ * lower bounds of Y, is final enough: it sets ts->miss and returns 0.
+ */
+int rta_vert(struct taskset *ts, struct vert *v, int nu,
+	     struct rta_count *c)
+{
+	const tick_t *e = ts->he + v->n->base;
+	const tick_t *p = ts->hp + v->n->base;
+	const tick_t *y = ts->hy + v->n->base;
+	struct task *t = v->t;
+	tick_t next_x, pred, cap = rta_cap(t);
+	int k, proof = ts->verdict && (ts->bound || nu == ts->rounds);
+
+	pred = 0;
+	for (k = t->pred_off[v->id]; k < t->pred_off[v->id + 1]; k++) {
+		if (pred < t->v[t->pred[k]].y)
+			pred = t->v[t->pred[k]].y;
+	}
+
+next_iteration:
+	next_x = 0;
+	c->inner++;
+
+	if (v->n->type == IONODE)
+		goto IO_operation;
+
+	c->term += v->ni;
+	if (ts->vec) {
+		double sum = rta_vsum(ts->fe + v->n->base, ts->fp + v->n->base,
+				      ts->fy + v->n->base, v->ni, v->x);
+
+		next_x = sum < VEC_EXACT ? (tick_t)sum : TICK_MAX;
+	} else {
+		next_x = rta_interference(e, p, y, v->ni, v->x);
+	}
+	if (next_x < TICK_MAX)
+		next_x = tick_div(next_x - v->sub, v->n->cpus);
+IO_operation:
+	next_x = tick_add(tick_add(next_x, v->e), pred);
+
+	if (next_x > cap)
+		next_x = cap;
+
+	if (proof && next_x > t->d) {
+		v->x = next_x;
+		__atomic_store_n(&ts->miss, 1, __ATOMIC_RELAXED);
+		return 0;
+	}
+
+	if (next_x > v->x) {
+		v->x = next_x;
+		goto next_iteration;
+	}
+
+	if (nu == 1 || v->x != v->y)
+		v->sr = nu;
+
+	if (v->x < v->y) {
+		if (nu <= 64)
+			v->upd |= 1ULL << (nu - 1);
+		return 1;
+	}
+
+	return 0;
+}
+
+int rta_record(struct taskset *ts, int nu, int nupd)
+{
+	int *tmp;
+
+	tmp = (int *)realloc(ts->nupd, (nu + 1) * sizeof(int));
+	if (!tmp)
+		return 1;
+
+	ts->nupd = tmp;
+	ts->nupd[nu] = nupd;
+	ts->nr = nu;
+
+	return 0;
+}
+
+int rta_finish(struct taskset *ts, int *sched)
+{
+	int i, j;
 
-fixedpoint_schedule:
 	*sched = 1;
 
+	ts->fixed = !ts->miss;
+	for (i = 0; i < ts->nv && ts->fixed; i++)
+		ts->fixed = ts->v[i]->x == ts->v[i]->y;
+
+	/* no resp or tard for ts->verdict, only the first miss */
+	if (ts->verdict) {
+		for (i = 0; i < ts->nv && !ts->miss; i++) {
+			if (ts->v[i]->x > ts->v[i]->t->d)
+				ts->miss = 1;
+		}
+
+		*sched = !ts->miss;
+		return 0;
+	}
+
 	for (i = 0; i < ts->nt; i++) {
 		struct task *t = &ts->t[i];
 
-		t->resp = 0.0;
+		t->resp = 0;
 		for (j = 0; j < t->nv; j++) {
 			struct vert *v = &t->v[j];
 
@@ -1728,40 +3305,4773 @@ fixedpoint_schedule:
 				t->resp = v->resp;
 				t->tard = t->resp - t->d;
 			}
+
+			if (v->x > t->d)
+				*sched = 0;
 		}
 	}
 
 	return 0;
 }
 
-int main(int argc, char **argv)
+struct rta_thread {
+	struct taskset *ts;
+	struct rta_thread *th;	/* all threads of this analysis		*/
+	pthread_barrier_t *bar;
+
+	int id;
+	int nth;
+	int lo, hi;		/* range of ts->v swept by this thread	*/
+	int nupd;		/* # of vertices with X < Y this round	*/
+	int nneq;		/* # of vertices with X != Y		*/
+	struct rta_count cnt;
+	int err;
+
+	pthread_t tid;
+};
+
+void node_changed(struct cl_node *n, int nu, int prio)
 {
-	struct taskset ts;
-	int sched;
+	int *chg = &n->chg[nu & 1];
+	int old = __atomic_load_n(chg, __ATOMIC_RELAXED);
+
+	while (old < prio &&
+	       !__atomic_compare_exchange_n(chg, &old, prio, 1,
+					    __ATOMIC_RELAXED,
+					    __ATOMIC_RELAXED))
+		;
+}
 
-	if (argc != 2)
-		err_exit("Usage: dag <file.xml>\n");
+/*
+ * For the worklist solver: X_v can only differ from the previous round
+ * if the Y of an interferer (same node, priority >= v->prio) or of a
+ * predecessor changed in the update that closed round nu - 1.
+ */
+int rta_dirty(struct vert *v, int nu)
+{
+	struct task *t = v->t;
+	int k;
 
-	if (taskset_parse(&ts, argv[1]))
-		err_exit("ERROR parsing XML file %s\n", argv[1]);
+	if (nu == 1)
+		return 1;
 
-	taskset_print(&ts);
+	if (v->n->type == CPUNODE && v->n->chg[(nu - 1) & 1] >= v->prio)
+		return 1;
 
-	if (rta(&ts, &sched))
-		err_exit("ERROR running sched. test\n"); 
+	for (k = t->pred_off[v->id]; k < t->pred_off[v->id + 1]; k++) {
+		if (t->v[t->pred[k]].yc)
+			return 1;
+	}
 
-	if (sched) {
-		printf("\nThe taskset is schedulable"
-			" according to RTA:\n");
-		taskset_stat(&ts);
-	} else {
-		printf("\nThe taskset is NOT schedulable"
-			" according to RTA.\n");
-		taskset_stat(&ts);
+	return 0;
+}
+
+#define BOUND_ROUNDS	2	/* lower-bound rounds for ts->verdict	*/
+
+/*
+ * Y only ever comes down to X from Y = d + 1, and X is monotone in Y:
+ * so a vector L <= d + 1 whose X(L) is at least L stays below Y in
+ * every round of the analysis, and X(L) below its final X. L = e is
+ * one (X never drops below e), and so is X(L) while it is within the
+ * deadlines. An X_v past its deadline from L thus proves a miss before
+ * the analysis even starts, which is the usual way an overloaded model
+ * fails. Returns 1 if it did.
+ */
+int rta_bound(struct rta_thread *th)
+{
+	struct taskset *ts = th->ts;
+	int i, k, r, nupd;
+
+	for (i = th->lo; i < th->hi; i++) {
+		struct vert *v = ts->v[i];
+
+		v->y = v->e;
+		rta_set_y(ts, v);
 	}
 
-	if (taskset_finalize(&ts))
-		err_exit("taskset_finalize\n");
+	if (th->id == 0)
+		ts->bound = 1;
+
+	pthread_barrier_wait(th->bar);
+
+	for (r = 0; r < BOUND_ROUNDS; r++) {
+		th->nupd = 0;
+		for (i = th->lo; i < th->hi; i++) {
+			struct vert *v = ts->v[i];
+
+			if (__atomic_load_n(&ts->miss, __ATOMIC_RELAXED))
+				break;
+
+			v->x = v->e;
+			rta_vert(ts, v, 1, &th->cnt);
+			th->nupd += v->x > v->y;
+		}
+
+		pthread_barrier_wait(th->bar);
+
+		nupd = 0;
+		for (k = 0; k < th->nth; k++)
+			nupd += th->th[k].nupd;
+
+		if (ts->miss || !nupd || r == BOUND_ROUNDS - 1)
+			break;
+
+		for (i = th->lo; i < th->hi; i++) {
+			struct vert *v = ts->v[i];
+
+			v->y = v->x;
+			rta_set_y(ts, v);
+		}
+
+		pthread_barrier_wait(th->bar);
+	}
+
+	if (ts->miss) {
+		if (th->id == 0) {
+			ts->by = BY_BOUND;
+			if (rta_record(ts, 0, 0))
+				th->err = 1;
+		}
+		return 1;
+	}
+
+	/* nobody sweeps again before the barrier after rta_vert_init() */
+	if (th->id == 0)
+		ts->bound = 0;
 
 	return 0;
 }
+
+/*
+ * Within a round every X_v depends only on the Y of the previous one,
+ * so each thread sweeps its own range of vertices; the barriers keep
+ * the Y = X update out of every other thread's sweep.
+ *
+ * X_v is monotone in every WCET, round by round, so the X of the same
+ * round of an analysis with no larger WCETs is a valid start for the
+ * inner iteration (ts->warm): it ends at the same fixed point.
+ */
+void *rta_worker(void *arg)
+{
+	struct rta_thread *th = (struct rta_thread *)arg;
+	struct taskset *ts = th->ts;
+	int i, k, nu, nupd, nneq;
+
+	if (ts->verdict && rta_bound(th))
+		return NULL;
+
+	for (i = th->lo; i < th->hi; i++)
+		rta_vert_init(ts, ts->v[i]);
+
+	if (th->id == 0) {
+		for (k = 0; k < ts->nn; k++) {
+			ts->n[k]->chg[0] = PRIO_MIN - 1;
+			ts->n[k]->chg[1] = PRIO_MIN - 1;
+		}
+	}
+
+	pthread_barrier_wait(th->bar);
+
+	for (nu = 1; ; nu++) {
+		/* nobody reads this slot before the next update */
+		if (th->id == 0 && ts->solver == SOLVER_WORKLIST) {
+			for (k = 0; k < ts->nn; k++)
+				ts->n[k]->chg[nu & 1] = PRIO_MIN - 1;
+		}
+
+		th->nupd = 0;
+		th->nneq = 0;
+		for (i = th->lo; i < th->hi; i++) {
+			struct vert *v = ts->v[i];
+
+			if (__atomic_load_n(&ts->miss, __ATOMIC_RELAXED))
+				break;
+
+			if (ts->solver == SOLVER_WORKLIST) {
+				if (!rta_dirty(v, nu))
+					continue;
+				v->x = v->e;
+			} else if (nu <= ts->nwarm) {
+				v->x = max(v->x, ts->warm[(size_t)(nu - 1) *
+							  ts->nv + i]);
+			}
+
+			th->nupd += rta_vert(ts, v, nu, &th->cnt);
+			th->nneq += v->x != v->y;
+
+			if (ts->traj && nu <= XI)
+				ts->traj[(size_t)(nu - 1) * ts->nv + i] = v->x;
+		}
+
+		pthread_barrier_wait(th->bar);
+
+		nupd = nneq = 0;
+		for (k = 0; k < th->nth; k++) {
+			nupd += th->th[k].nupd;
+			nneq += th->th[k].nneq;
+		}
+
+		if (th->id == 0 && rta_record(ts, nu, nupd))
+			th->err = 1;
+
+		if (!(ts->exact ? nneq : nupd))
+			break;
+		if (ts->rounds && nu + 1 > ts->rounds) {
+			if (th->id == 0)
+				ts->capped = 1;
+			break;
+		}
+
+		for (i = th->lo; i < th->hi; i++) {
+			struct vert *v = ts->v[i];
+
+			if (ts->solver == SOLVER_WORKLIST) {
+				v->yc = v->x != v->y;
+				if (v->yc)
+					node_changed(v->n, nu, v->prio);
+
+				v->y = v->x;
+				rta_set_y(ts, v);
+				continue;
+			}
+
+			v->y = v->x;
+			rta_set_y(ts, v);
+			v->x = v->e;
+		}
+
+		pthread_barrier_wait(th->bar);
+	}
+
+	return NULL;
+}
+
+/* fold a finished analysis, nu = ts->nr rounds, into ts->st */
+void rta_stats_add(struct taskset *ts, struct rta_count *c)
+{
+	ts->st.nrta++;
+	ts->st.nrounds += ts->nr;
+	ts->st.ncapped += ts->capped;
+	ts->st.ninner += c->inner;
+	ts->st.nterm += c->term;
+}
+
+/* fold the analyses run on a copy of ts back into it */
+void rta_stats_merge(struct taskset *ts, struct taskset *cp)
+{
+	int i;
+
+	ts->st.prepare.wall += cp->st.prepare.wall;
+	ts->st.prepare.cpu += cp->st.prepare.cpu;
+	ts->st.iter.wall += cp->st.iter.wall;
+	ts->st.iter.cpu += cp->st.iter.cpu;
+	ts->st.nrta += cp->st.nrta;
+	ts->st.nrounds += cp->st.nrounds;
+	ts->st.ncapped += cp->st.ncapped;
+	ts->st.ninner += cp->st.ninner;
+	ts->st.nterm += cp->st.nterm;
+
+	for (i = 0; i < ts->nt && i < cp->nt; i++)
+		ts->t[i].nreach += cp->t[i].nreach;
+}
+
+/*
+ * Necessary conditions checked in linear time before any analysis. A
+ * critical path longer than d is a miss for the RTA too: X_v is never
+ * below e_v plus the Y of its predecessors, and Y never below the path
+ * lengths capped at d + 1 (see rta_bound()). More work per period on a
+ * CPU node than its CPUs can run is a miss for any analysis. Returns 1
+ * if one fails, with ts->by, ts->byt and ts->byn saying which.
+ */
+int rta_pretest(struct taskset *ts)
+{
+	struct cl_node *n;
+	tick_t cpu;
+	int i, j;
+
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		if (t->len > t->d) {
+			ts->by = BY_LENGTH;
+			ts->byt = t;
+			return 1;
+		}
+	}
+
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		/* every node has a CPU, so a task that fits one fits all */
+		if (t->vol <= t->p)
+			continue;
+
+		list_for_each_entry(n, &t->nodes, lnode)
+			n->load = 0;
+		for (j = 0; j < t->nv; j++)
+			t->v[j].n->load = tick_add(t->v[j].n->load, t->v[j].e);
+
+		list_for_each_entry(n, &t->nodes, lnode) {
+			if (n->type != CPUNODE)
+				continue;
+			if (__builtin_mul_overflow(t->p, n->cpus, &cpu) ||
+			    n->load <= cpu)
+				continue;
+
+			ts->by = BY_LOAD;
+			ts->byt = t;
+			ts->byn = n;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int rta(struct taskset *ts, int *sched)
+{
+	struct rta_count cnt = { 0, 0 };
+	struct rta_thread *th;
+	struct phase_clock c;
+	pthread_barrier_t bar;
+	double cost, part;
+	int nth, i, k, err = 0;
+
+	if (!ts)
+		return 1;
+
+	if (taskset_update(ts))
+		return 1;
+
+	ts->by = BY_RTA;
+	ts->capped = 0;
+	if (ts->verdict && rta_pretest(ts)) {
+		ts->miss = 1;
+		*sched = 0;
+		return 0;
+	}
+
+	phase_start(&c);
+	if (ts->dirty && rta_prepare(ts))
+		return 1;
+
+	rta_hot(ts);
+	phase_stop(&c, &ts->st.prepare);
+
+	nth = min(max(ts->nth, 1), ts->nv);
+	ts->miss = 0;
+
+	th = (struct rta_thread *)calloc(nth, sizeof(struct rta_thread));
+	if (!th)
+		return 1;
+
+	if (pthread_barrier_init(&bar, NULL, nth)) {
+		free(th);
+		return 1;
+	}
+
+	/* split ts->v, which is grouped by node, into ranges of equal work */
+	cost = 0.0;
+	for (i = 0; i < ts->nv; i++)
+		cost += 1.0 + ts->v[i]->ni;
+
+	part = 0.0;
+	for (i = 0, k = 0; k < nth; k++) {
+		th[k].ts = ts;
+		th[k].th = th;
+		th[k].bar = &bar;
+		th[k].id = k;
+		th[k].nth = nth;
+
+		th[k].lo = i;
+		while (i < ts->nv && (part < cost * (k + 1) / nth ||
+				      k == nth - 1))
+			part += 1.0 + ts->v[i++]->ni;
+		th[k].hi = i;
+	}
+
+	phase_start(&c);
+	for (k = 1; k < nth; k++) {
+		if (pthread_create(&th[k].tid, NULL, rta_worker, &th[k]))
+			err_exit("ERROR creating RTA thread\n");
+	}
+
+	rta_worker(&th[0]);
+
+	for (k = 1; k < nth; k++)
+		pthread_join(th[k].tid, NULL);
+	phase_stop(&c, &ts->st.iter);
+
+	err = th[0].err;
+	for (k = 0; k < nth; k++) {
+		cnt.inner += th[k].cnt.inner;
+		cnt.term += th[k].cnt.term;
+	}
+
+	pthread_barrier_destroy(&bar);
+	free(th);
+
+	if (err)
+		return 1;
+
+	rta_stats_add(ts, &cnt);
+	return rta_finish(ts, sched);
+}
+
+#define WHATIF_WCET	0
+#define WHATIF_PRIO	1
+#define WHATIF_NODE	2
+struct whatif {
+	int task;		/* task of the edited vertex		*/
+	int vert;		/* edited vertex			*/
+	int what;		/* WHATIF_WCET, WHATIF_PRIO or WHATIF_NODE */
+
+	tick_t e;		/* new execution time			*/
+	int prio;		/* new priority				*/
+	struct cl_node *n;	/* new node				*/
+};
+
+/* 1 if the edit can't be applied to ts */
+int whatif_check(struct taskset *ts, struct whatif *w)
+{
+	if (w->task < 0 || w->task >= ts->nt)
+		return 1;
+
+	if (w->vert < 0 || w->vert >= ts->t[w->task].nv)
+		return 1;
+
+	switch (w->what) {
+	case WHATIF_WCET:
+		return w->e <= 0 || w->e > TICK_MAX;
+	case WHATIF_PRIO:
+		return w->prio < PRIO_MIN || w->prio > PRIO_MAX;
+	case WHATIF_NODE:
+		return !w->n || (w->n->type == CPUNODE && w->n->cpus < 1);
+	}
+
+	return 1;
+}
+
+int whatif_apply(struct taskset *ts, struct whatif *w)
+{
+	struct task *t = &ts->t[w->task];
+
+	switch (w->what) {
+	case WHATIF_WCET:
+		return task_set_wcet(t, w->vert, w->e);
+	case WHATIF_PRIO:
+		return task_set_prio(t, w->vert, w->prio);
+	case WHATIF_NODE:
+		return task_set_node(t, w->vert, w->n);
+	}
+
+	return 1;
+}
+
+int whatif_move(struct vert *v, struct cl_node *from)
+{
+	struct vert **tmp;
+	int k;
+
+	for (k = 0; k < from->niv; k++) {
+		if (from->iv[k] == v)
+			break;
+	}
+
+	memmove(&from->iv[k], &from->iv[k + 1],
+		(from->niv - k - 1) * sizeof(struct vert *));
+	from->niv--;
+
+	tmp = (struct vert **)realloc(v->n->iv,
+				      (v->n->niv + 1) * sizeof(struct vert *));
+	if (!tmp)
+		return 1;
+
+	v->n->iv = tmp;
+	v->n->iv[v->n->niv++] = v;
+
+	return 0;
+}
+
+#define MARK_FWD	1	/* X may change				*/
+#define MARK_BWD	2	/* read by some vertex whose X may change */
+
+int whatif_push(struct vert **q, int *nq, struct vert *v, int mark)
+{
+	if (v->mark & mark)
+		return 0;
+
+	if (!v->mark)
+		q[(*nq)++] = v;
+	v->mark |= mark;
+
+	return 1;
+}
+
+/*
+ * Apply one edit to an analysed taskset and update the results of
+ * rta() without repeating it from scratch. Only the vertices whose X
+ * may change, and the vertices they read from, are iterated again; the
+ * others keep the values of the previous analysis. When those values
+ * cannot be proven equal to what a full run would compute, this falls
+ * back to rta().
+ */
+int rta_whatif(struct taskset *ts, struct whatif *w, int *sched)
+{
+	struct rta_count c = { 0, 0 };
+	struct vert *v, **q;
+	struct cl_node *n_old;
+	int *cnt, nq, head, nr_old, prio_old;
+	int i, j, k, nu, nupd;
+
+	/* rejected edits leave the taskset and its results as they are */
+	if (!ts || !w || whatif_check(ts, w))
+		return 1;
+
+	if (taskset_update(ts))
+		return 1;
+
+	/*
+	 * Rounds are tracked in 64-bit masks, --exact has no increments,
+	 * and the rounds of a warm start are not those from d + 1.
+	 */
+	if (!ts->nr || ts->nr > 64 || ts->dirty || ts->exact ||
+	    ts->ystart) {
+		if (whatif_apply(ts, w))
+			return 1;
+
+		ts->ystart = 0;
+		return rta(ts, sched);
+	}
+
+	v = &ts->t[w->task].v[w->vert];
+	n_old = v->n;
+	prio_old = v->prio;
+
+	if (whatif_apply(ts, w))
+		return 1;
+
+	if (taskset_update(ts))
+		return 1;
+
+	if (v->n != n_old) {
+		if (v->n->idx < 0)
+			return rta(ts, sched);
+
+		if (whatif_move(v, n_old))
+			return 1;
+		node_prepare(v->n);
+	}
+	node_prepare(n_old);
+	ts->dirty = 0;
+	rta_hot(ts);
+
+	q = (struct vert **)malloc(ts->nv * sizeof(struct vert *));
+	cnt = (int *)calloc(ts->nr + 2, sizeof(int));
+	if (!q || !cnt) {
+		free(q);
+		free(cnt);
+		return 1;
+	}
+
+	for (i = 0; i < ts->nn; i++) {
+		ts->n[i]->wf = PRIO_MIN - 1;
+		ts->n[i]->wb = 0;
+	}
+
+	/*
+	 * Forward: the edited vertex, the vertices that had it as an
+	 * interferer before the edit, and everything depending on them
+	 * through precedence or interference.
+	 */
+	nq = 0;
+	whatif_push(q, &nq, v, MARK_FWD);
+	if (n_old->type == CPUNODE) {
+		for (k = n_old->niv - 1; k >= 0; k--) {
+			if (n_old->iv[k]->prio > prio_old)
+				break;
+			whatif_push(q, &nq, n_old->iv[k], MARK_FWD);
+		}
+	}
+
+	for (head = 0; head < nq; head++) {
+		struct vert *u = q[head];
+		struct cl_node *n = u->n;
+		struct task *t = u->t;
+
+		for (k = t->succ_off[u->id]; k < t->succ_off[u->id + 1]; k++)
+			whatif_push(q, &nq, &t->v[t->succ[k]], MARK_FWD);
+
+		if (n->type == IONODE || u->prio <= n->wf)
+			continue;
+
+		for (k = n->niv - 1; k >= 0; k--) {
+			if (n->iv[k]->prio > u->prio)
+				break;
+			if (n->iv[k]->prio > n->wf)
+				whatif_push(q, &nq, n->iv[k], MARK_FWD);
+		}
+		n->wf = u->prio;
+	}
+
+	/* backward: whatever the forward set reads, transitively */
+	for (head = 0; head < nq; head++) {
+		struct vert *u = q[head];
+		struct cl_node *n = u->n;
+		struct task *t = u->t;
+
+		for (k = t->pred_off[u->id]; k < t->pred_off[u->id + 1]; k++)
+			whatif_push(q, &nq, &t->v[t->pred[k]], MARK_BWD);
+
+		for (k = n->wb; k < u->ni; k++)
+			whatif_push(q, &nq, n->iv[k], MARK_BWD);
+		n->wb = max(n->wb, u->ni);
+	}
+
+	/* per round, the vertices outside q whose X decreased */
+	nr_old = ts->nr;
+	for (nu = 1; nu <= nr_old; nu++) {
+		cnt[nu] = ts->nupd[nu];
+
+		for (i = 0; i < nq; i++) {
+			if (q[i]->upd & (1ULL << (nu - 1)))
+				cnt[nu]--;
+		}
+	}
+
+	for (i = 0; i < nq; i++)
+		rta_vert_init(ts, q[i]);
+
+	ts->capped = 0;
+	for (nu = 1; ; nu++) {
+		nupd = 0;
+
+		for (i = 0; i < nq; i++)
+			nupd += rta_vert(ts, q[i], nu, &c);
+
+		if (nu <= nr_old)
+			nupd += cnt[nu];
+
+		if (rta_record(ts, nu, nupd))
+			goto out_err;
+
+		if (!nupd)
+			break;
+		if (ts->rounds && nu + 1 > ts->rounds) {
+			ts->capped = 1;
+			break;
+		}
+
+		for (i = 0; i < nq; i++) {
+			q[i]->y = q[i]->x;
+			rta_set_y(ts, q[i]);
+			q[i]->x = q[i]->e;
+		}
+	}
+
+	/*
+	 * The vertices outside q kept their final X from the previous
+	 * analysis: valid only if they had settled by round nu, and had
+	 * settled before its last round if this one runs longer.
+	 */
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		for (j = 0; j < t->nv; j++) {
+			struct vert *u = &t->v[j];
+
+			if (u->mark & MARK_FWD)
+				continue;
+
+			if (u->sr > nu || (nu > nr_old && u->sr >= nr_old))
+				goto out_full;
+		}
+	}
+
+	for (i = 0; i < nq; i++)
+		q[i]->mark = 0;
+
+	free(q);
+	free(cnt);
+	rta_stats_add(ts, &c);
+	return rta_finish(ts, sched);
+
+out_full:
+	for (i = 0; i < nq; i++)
+		q[i]->mark = 0;
+
+	free(q);
+	free(cnt);
+	return rta(ts, sched);
+
+out_err:
+	for (i = 0; i < nq; i++)
+		q[i]->mark = 0;
+
+	free(q);
+	free(cnt);
+	return 1;
+}
+
+/*
+ * Saved bounds (--save-bounds, --warm): the final Y of every vertex of
+ * a schedulable analysis that ended at a fixed point, with the WCETs
+ * it used. Lowering a WCET lowers every X, round by round, so the new
+ * greatest fixed point below d + 1 is below the saved one, and the
+ * rounds from the saved Y descend to it: to the same bounds as from
+ * d + 1, in fewer rounds. That holds while the tasks, deadlines,
+ * periods, edges, priorities and nodes are the ones hashed in the
+ * header and no WCET grew. Values are in the byte order of the writer.
+ */
+#define BOUNDS_MAGIC	"RTSY"
+#define BOUNDS_VERSION	1
+
+#define WARM_OK		0
+#define WARM_FILE	1	/* missing, short or of another tool	*/
+#define WARM_MODEL	2	/* other structure or resolution	*/
+#define WARM_WCET	3	/* some WCET is larger than saved	*/
+#define WARM_COLD	4	/* no fixed point from them, rerun cold	*/
+
+struct bounds_header {
+	char magic[4];
+	uint32_t version;
+	uint32_t order;		/* RTSB_ORDER as written		*/
+	uint32_t nv;		/* vertices over all tasks		*/
+	int64_t res;		/* ticks per model time unit		*/
+	uint64_t hash;		/* bounds_hash() of the model		*/
+};
+
+struct bounds_vert {
+	int64_t e;		/* WCET the bound was computed with	*/
+	int64_t y;
+};
+
+uint64_t bounds_mix(uint64_t h, const void *buf, size_t len)
+{
+	const unsigned char *p = (const unsigned char *)buf;
+
+	while (len--)
+		h = (h ^ *p++) * 1099511628211ULL;
+
+	return h;
+}
+
+/* FNV-1a of everything but the WCETs the bounds depend on */
+uint64_t bounds_hash(struct taskset *ts)
+{
+	uint64_t h = 14695981039346656037ULL;
+	int i, j;
+
+	h = bounds_mix(h, &ts->nt, sizeof(ts->nt));
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		h = bounds_mix(h, &t->d, sizeof(t->d));
+		h = bounds_mix(h, &t->p, sizeof(t->p));
+		h = bounds_mix(h, &t->nv, sizeof(t->nv));
+		h = bounds_mix(h, t->succ_off, (t->nv + 1) * sizeof(int));
+		h = bounds_mix(h, t->succ, t->ne * sizeof(int));
+
+		for (j = 0; j < t->nv; j++) {
+			struct vert *v = &t->v[j];
+
+			h = bounds_mix(h, &v->prio, sizeof(v->prio));
+			h = bounds_mix(h, v->n->name, strlen(v->n->name) + 1);
+			h = bounds_mix(h, &v->n->type, sizeof(v->n->type));
+			h = bounds_mix(h, &v->n->cpus, sizeof(v->n->cpus));
+		}
+	}
+
+	return h;
+}
+
+int bounds_save(struct taskset *ts, const char *file)
+{
+	struct bounds_header h;
+	struct bounds_vert b;
+	FILE *f;
+	int i, j, ret = 1;
+
+	if (!ts || !ts->t || taskset_update(ts))
+		return 1;
+
+	memset(&h, 0, sizeof(h));
+	memcpy(h.magic, BOUNDS_MAGIC, 4);
+	h.version = BOUNDS_VERSION;
+	h.order = RTSB_ORDER;
+	h.res = tick_res;
+	h.hash = bounds_hash(ts);
+	for (i = 0; i < ts->nt; i++)
+		h.nv += ts->t[i].nv;
+
+	f = fopen(file, "wb");
+	if (!f)
+		return 1;
+
+	if (fwrite(&h, sizeof(h), 1, f) != 1)
+		goto out;
+
+	for (i = 0; i < ts->nt; i++) {
+		for (j = 0; j < ts->t[i].nv; j++) {
+			b.e = ts->t[i].v[j].e;
+			b.y = ts->t[i].v[j].x;
+			if (fwrite(&b, sizeof(b), 1, f) != 1)
+				goto out;
+		}
+	}
+
+	ret = 0;
+out:
+	if (fclose(f))
+		ret = 1;
+	if (ret)
+		unlink(file);
+
+	return ret;
+}
+
+/* set v->ys and ts->ystart from file if its bounds hold, else WARM_* */
+int bounds_load(struct taskset *ts, const char *file)
+{
+	struct bounds_header h;
+	struct bounds_vert b;
+	uint32_t nv = 0;
+	FILE *f;
+	int i, j, ret = WARM_FILE;
+
+	if (!ts || !ts->t || taskset_update(ts))
+		return WARM_FILE;
+
+	f = fopen(file, "rb");
+	if (!f)
+		return WARM_FILE;
+
+	if (fread(&h, sizeof(h), 1, f) != 1 ||
+	    memcmp(h.magic, BOUNDS_MAGIC, 4) ||
+	    h.version != BOUNDS_VERSION || h.order != RTSB_ORDER)
+		goto out;
+
+	for (i = 0; i < ts->nt; i++)
+		nv += ts->t[i].nv;
+
+	ret = WARM_MODEL;
+	if (h.res != tick_res || h.nv != nv || h.hash != bounds_hash(ts))
+		goto out;
+
+	for (i = 0; i < ts->nt; i++) {
+		for (j = 0; j < ts->t[i].nv; j++) {
+			struct vert *v = &ts->t[i].v[j];
+
+			if (fread(&b, sizeof(b), 1, f) != 1) {
+				ret = WARM_FILE;
+				goto out;
+			}
+
+			if (b.y < b.e || b.y > v->t->d) {
+				ret = WARM_FILE;
+				goto out;
+			}
+
+			if (v->e > b.e) {
+				ret = WARM_WCET;
+				goto out;
+			}
+			v->ys = b.y;
+		}
+	}
+
+	ts->ystart = 1;
+	ret = WARM_OK;
+out:
+	fclose(f);
+	return ret;
+}
+
+int whatif_parse(struct taskset *ts, const char *spec, struct whatif *w)
+{
+	char what[16], val[256], *end;
+	struct cl_node *n;
+	long prio;
+
+	if (sscanf(spec, "%d:%d:%15[a-z]=%255s", &w->task, &w->vert,
+		   what, val) != 4)
+		return 1;
+
+	if (w->task < 0 || w->task >= ts->nt)
+		return 1;
+
+	if (strcmp(what, "wcet") == 0) {
+		w->what = WHATIF_WCET;
+		if (tick_parse(val, 1, &w->e))
+			return 1;
+	} else if (strcmp(what, "prio") == 0) {
+		w->what = WHATIF_PRIO;
+		prio = strtol(val, &end, 10);
+		if (*end || prio < PRIO_MIN || prio > PRIO_MAX)
+			return 1;
+		w->prio = prio;
+	} else if (strcmp(what, "node") == 0) {
+		w->what = WHATIF_NODE;
+		w->n = NULL;
+
+		list_for_each_entry(n, &ts->t[w->task].nodes, lnode) {
+			if (strcmp(n->name, val) == 0) {
+				w->n = n;
+				break;
+			}
+		}
+	} else {
+		return 1;
+	}
+
+	return whatif_check(ts, w);
+}
+
+#define OPA_FOUND	0	/* the RTA accepts the assignment	*/
+#define OPA_INFEASIBLE	1	/* no vertex fits the lowest level even
+				   with critical paths as response times */
+#define OPA_NOT_FOUND	2	/* the search or refinement gave up	*/
+
+#define OPA_PASSES	16
+
+/*
+ * Interference table of one level: the unassigned vertices of a node
+ * grouped by task and sorted by Y, with prefix sums of their WCETs, so
+ * that every candidate check at the level costs a few binary searches
+ * per task instead of a pass over all of them.
+ */
+struct opa_tab {
+	struct vert **r;	/* unassigned vertices			*/
+	int nr;
+
+	tick_t *y;		/* Y of r[], by task then increasing Y	*/
+	tick_t *pre;		/* pre[k] = sum of e of entries < k	*/
+	int *seg;		/* entries of task k: seg[k] .. seg[k + 1] */
+	tick_t *p;		/* period of task k			*/
+	int nseg;
+};
+
+int opa_ent_cmp(const void *a, const void *b)
+{
+	const struct vert *va = *(struct vert **)a, *vb = *(struct vert **)b;
+
+	if (va->t->id != vb->t->id)
+		return va->t->id - vb->t->id;
+
+	return (va->y > vb->y) - (va->y < vb->y);
+}
+
+void opa_tab_build(struct opa_tab *tab)
+{
+	struct vert **r = tab->r;
+	int k;
+
+	sort(r, tab->nr, sizeof(struct vert *), opa_ent_cmp);
+
+	tab->nseg = 0;
+	tab->pre[0] = 0;
+	for (k = 0; k < tab->nr; k++) {
+		if (k == 0 || r[k]->t != r[k - 1]->t) {
+			tab->seg[tab->nseg] = k;
+			tab->p[tab->nseg++] = r[k]->t->p;
+		}
+
+		tab->y[k] = r[k]->y;
+		tab->pre[k + 1] = tick_add(tab->pre[k], r[k]->e);
+	}
+	tab->seg[tab->nseg] = tab->nr;
+}
+
+/* sum of ceil((Y + x) / p) * e over the table, as rta_vert() adds it */
+tick_t opa_interference(struct opa_tab *tab, tick_t x)
+{
+	tick_t sum = 0, w;
+	int s;
+
+	for (s = 0; s < tab->nseg; s++) {
+		tick_t p = tab->p[s];
+		int lo = tab->seg[s], end = tab->seg[s + 1];
+
+		while (lo < end) {
+			tick_t j = (tab->y[lo] + x + p - 1) / p;
+			int l = lo + 1, h = end;
+
+			/* entries with the same number of jobs as y[lo] */
+			while (l < h) {
+				int mid = (l + h) / 2;
+
+				if ((tab->y[mid] + x + p - 1) / p <= j)
+					l = mid + 1;
+				else
+					h = mid;
+			}
+
+			w = tab->pre[l] - tab->pre[lo];
+			if (__builtin_mul_overflow(j, w, &w) ||
+			    w > TICK_MAX - sum)
+				return TICK_MAX;
+			sum += w;
+			lo = l;
+		}
+	}
+
+	return sum;
+}
+
+/*
+ * Response time of v at the lowest priority among the unassigned
+ * vertices of its node, all of which interfere, with the Y of every
+ * vertex held fixed. v->sub holds the WCETs of the unassigned vertices
+ * of its task that v reaches.
+ */
+tick_t opa_resp(struct vert *v, struct opa_tab *tab)
+{
+	struct task *t = v->t;
+	tick_t x, next_x, pred = 0, cap = rta_cap(t);
+	int k;
+
+	for (k = t->pred_off[v->id]; k < t->pred_off[v->id + 1]; k++) {
+		if (pred < t->v[t->pred[k]].y)
+			pred = t->v[t->pred[k]].y;
+	}
+
+	x = v->e;
+	for (;;) {
+		next_x = opa_interference(tab, x);
+		if (next_x < TICK_MAX)
+			next_x = tick_div(next_x - v->sub, v->n->cpus);
+		next_x = tick_add(tick_add(next_x, v->e), pred);
+
+		if (next_x >= cap)
+			return cap;
+		if (next_x <= x)
+			return x;
+
+		x = next_x;
+	}
+}
+
+/* slack of a vertex against the latest response that fits its task */
+tick_t opa_slack(struct vert *v)
+{
+	return v->t->d - v->l_from + v->e - v->x;
+}
+
+int opa_slack_cmp(const void *a, const void *b)
+{
+	tick_t sa = opa_slack(*(struct vert **)a);
+	tick_t sb = opa_slack(*(struct vert **)b);
+
+	if (sa != sb)
+		return (sa < sb) - (sa > sb);
+
+	return opa_ent_cmp(a, b);
+}
+
+/*
+ * Audsley's lowest-priority-first search on one node. A vertex fits a
+ * level if it still meets its deadline, after leaving room for the
+ * critical path that follows it, when all unassigned vertices interfere.
+ * Vertices sharing a level interfere with each other, so each level
+ * takes no more of the fitting vertices (largest slack first) than
+ * needed to place the rest on the levels left.
+ *
+ * Returns 0 if every vertex got a level, 2 if none fits the lowest one,
+ * which no assignment can avoid, and 1 if the search gave up at a
+ * higher level, which may be the grouping's fault.
+ */
+int opa_node(struct cl_node *n, struct opa_tab *tab)
+{
+	struct vert **r = tab->r;
+	int prio, nfit, take, k, j, i;
+
+	memcpy(r, n->iv, n->niv * sizeof(struct vert *));
+	tab->nr = n->niv;
+
+	for (k = 0; k < tab->nr; k++) {
+		r[k]->sub = 0;
+		for (j = 0; j < tab->nr; j++) {
+			if (r[j]->t == r[k]->t && j != k &&
+			    task_reachable(r[k]->t, r[k], r[j]))
+				r[k]->sub = tick_add(r[k]->sub, r[j]->e);
+		}
+	}
+
+	for (prio = PRIO_MIN; tab->nr > 0; prio++) {
+		opa_tab_build(tab);
+
+		nfit = 0;
+		for (k = 0; k < tab->nr; k++) {
+			struct vert *v = r[k];
+
+			v->x = opa_resp(v, tab);
+			if (opa_slack(v) >= 0) {
+				r[k] = r[nfit];
+				r[nfit++] = v;
+			}
+		}
+
+		if (!nfit && prio == PRIO_MIN)
+			return 2;
+		if (!nfit || (prio == PRIO_MAX && nfit < tab->nr))
+			return 1;
+
+		sort(r, nfit, sizeof(struct vert *), opa_slack_cmp);
+
+		take = (tab->nr + PRIO_MAX - prio) / (PRIO_MAX - prio + 1);
+		take = min(nfit, take);
+
+		for (k = 0; k < take; k++)
+			task_set_prio(r[k]->t, r[k]->id, prio);
+
+		/* the assigned vertices stop interfering with the rest */
+		for (k = take; k < tab->nr; k++) {
+			struct vert *v = r[k];
+
+			for (i = 0; i < take; i++) {
+				if (r[i]->t == v->t &&
+				    task_reachable(v->t, v, r[i]))
+					v->sub -= r[i]->e;
+			}
+		}
+
+		for (j = 0, k = take; k < tab->nr; k++)
+			r[j++] = r[k];
+		tab->nr = j;
+	}
+
+	return 0;
+}
+
+int opa_save(struct taskset *ts, int *prio)
+{
+	int i, j, k = 0;
+
+	for (i = 0; i < ts->nt; i++)
+		for (j = 0; j < ts->t[i].nv; j++)
+			prio[k++] = ts->t[i].v[j].prio;
+
+	return k;
+}
+
+int rta_opa(struct taskset *ts, int *res)
+{
+	struct opa_tab tab;
+	int *prio = NULL, pass, sched, i, j, k, same, nr = 0, ret = 1, fail = 0;
+	tick_t *est = NULL;
+
+	if (taskset_update(ts))
+		return 1;
+
+	if (ts->dirty && rta_prepare(ts))
+		return 1;
+
+	for (i = 0; i < ts->nn; i++)
+		nr = max(nr, ts->n[i]->niv);
+
+	tab.r = (struct vert **)malloc((nr + 1) * sizeof(struct vert *));
+	tab.y = (tick_t *)malloc((nr + 1) * sizeof(tick_t));
+	tab.pre = (tick_t *)malloc((nr + 1) * sizeof(tick_t));
+	tab.seg = (int *)malloc((nr + 1) * sizeof(int));
+	tab.p = (tick_t *)malloc((nr + 1) * sizeof(tick_t));
+
+	/* per vertex, in task order: given and previous priorities, Y */
+	prio = (int *)malloc(2 * ts->nv * sizeof(int));
+	est = (tick_t *)malloc(ts->nv * sizeof(tick_t));
+	if (!tab.r || !tab.y || !tab.pre || !tab.seg || !tab.p ||
+	    !prio || !est)
+		goto out;
+
+	opa_save(ts, prio);
+	for (i = 0, k = 0; i < ts->nt; i++)
+		for (j = 0; j < ts->t[i].nv; j++)
+			est[k++] = ts->t[i].v[j].l_to;
+
+	*res = OPA_NOT_FOUND;
+	for (pass = 0; pass < OPA_PASSES; pass++) {
+		opa_save(ts, &prio[ts->nv]);
+
+		/* rta() overwrites Y, so it is reloaded on every pass */
+		for (i = 0, k = 0; i < ts->nt; i++)
+			for (j = 0; j < ts->t[i].nv; j++)
+				ts->t[i].v[j].y = est[k++];
+
+		for (i = 0; i < ts->nn; i++) {
+			if (ts->n[i]->type == IONODE)
+				continue;
+
+			fail = opa_node(ts->n[i], &tab);
+			if (fail)
+				break;
+		}
+
+		if (i < ts->nn) {
+			/* only pass 0 has Y at their lower bounds */
+			if (pass == 0 && fail == 2)
+				*res = OPA_INFEASIBLE;
+			break;
+		}
+
+		/* the same assignment would give the same estimates */
+		same = pass > 0;
+		for (i = 0, k = 0; i < ts->nt && same; i++)
+			for (j = 0; j < ts->t[i].nv && same; j++)
+				same = prio[ts->nv + k++] == ts->t[i].v[j].prio;
+		if (same)
+			break;
+
+		if (rta(ts, &sched))
+			goto out;
+
+		if (sched) {
+			*res = OPA_FOUND;
+			break;
+		}
+
+		for (i = 0, k = 0; i < ts->nt; i++) {
+			struct task *t = &ts->t[i];
+
+			for (j = 0; j < t->nv; j++, k++) {
+				struct vert *v = &t->v[j];
+
+				est[k] = max(est[k], min(v->resp,
+						t->d - v->l_from + v->e));
+			}
+		}
+	}
+
+	if (*res != OPA_FOUND) {
+		for (i = 0, k = 0; i < ts->nt; i++)
+			for (j = 0; j < ts->t[i].nv; j++)
+				task_set_prio(&ts->t[i], j, prio[k++]);
+
+		if (*res == OPA_NOT_FOUND) {
+			if (rta(ts, &sched))
+				goto out;
+
+			if (sched)
+				*res = OPA_FOUND;
+		}
+	}
+
+	ret = 0;
+out:
+	free(tab.r);
+	free(tab.y);
+	free(tab.pre);
+	free(tab.seg);
+	free(tab.p);
+	free(prio);
+	free(est);
+	return ret;
+}
+
+#define MAP_NODES	0	/* fewest CPU nodes hosting some vertex	*/
+#define MAP_UTIL	1	/* lowest utilization of any CPU node	*/
+
+#define MAP_FOUND	0	/* the mapping is schedulable		*/
+#define MAP_NOT_FOUND	1	/* no schedulable mapping was reached	*/
+
+#define MAP_MOVES	4096	/* moves taken at most			*/
+#define MAP_REPAIR	32	/* candidates tried per repair step	*/
+#define MAP_REPAIR_MOVES 64	/* repair moves taken at most		*/
+#define MAP_EPS		1e-12	/* utilizations closer than this tie	*/
+
+struct map_key {
+	int nodes;		/* CPU nodes hosting some vertex	*/
+	double umax;		/* largest utilization of a CPU node	*/
+	double usq;		/* sum of squared utilizations		*/
+};
+
+struct map_cand {
+	int v;			/* vertex, in task order		*/
+	int to;			/* node it moves to			*/
+	struct map_key key;	/* of the mapping after the move	*/
+};
+
+struct map_move {
+	int v, to;
+};
+
+/*
+ * Search state. Nodes are numbered task by task in the order of the
+ * task node lists, vertices task by task, so that every thread finds
+ * both in its own copy of the taskset.
+ */
+struct map {
+	struct taskset *ts;
+	int obj;		/* MAP_NODES or MAP_UTIL		*/
+
+	struct vert **v;	/* vertices of ts			*/
+	int nv;
+	struct cl_node **n;	/* nodes of ts				*/
+	int *nt;		/* task of each node			*/
+	int nn;
+
+	int *cur;		/* node of each vertex			*/
+	tick_t *load;		/* WCETs on each node			*/
+	int *cnt;		/* vertices on each node		*/
+	struct map_key key;	/* of the current mapping		*/
+	int top[3];		/* nodes of largest utilization		*/
+	struct taskset *ref;	/* a copy analysed with it		*/
+	int sched;		/* the current mapping is schedulable	*/
+	tick_t tard;		/* and its largest task tardiness	*/
+
+	struct map_move *mv;	/* moves taken				*/
+	int nmv;
+	int nrep;		/* of which repairs			*/
+
+	struct map_cand *c;	/* candidates of this step, best first	*/
+	int nc;
+	int *csched;		/* per candidate, verdict and largest	*/
+	tick_t *ctard;		/* task tardiness			*/
+	int repair;		/* the current mapping misses: any move
+				   of a late vertex that lowers tard	*/
+	int next;		/* next candidate to evaluate		*/
+	int found;		/* first candidate that improves	*/
+	int err;
+
+	pthread_barrier_t *bar;	/* start and end of every step		*/
+	int stop;		/* the workers exit at the next start	*/
+};
+
+struct map_thread {
+	struct map *m;
+	struct taskset ts;	/* private copy evaluated by this thread */
+	struct cl_node **n;	/* its nodes, numbered as m->n		*/
+	int nmv;		/* moves of m->mv applied to it		*/
+	int kv, kto, kfrom;	/* improving move left applied, kv >= 0	*/
+
+	pthread_t tid;
+};
+
+double map_util(struct map *m, int g, tick_t load)
+{
+	return (double)load /
+	       ((double)m->ts->t[m->nt[g]].p * m->n[g]->cpus);
+}
+
+/* x better than y for obj: < 0 */
+int map_key_cmp(int obj, struct map_key *x, struct map_key *y)
+{
+	if (obj == MAP_NODES) {
+		if (x->nodes != y->nodes)
+			return x->nodes - y->nodes;
+		/* concentrated load empties nodes */
+		if (fabs(x->usq - y->usq) > MAP_EPS)
+			return x->usq > y->usq ? -1 : 1;
+		if (fabs(x->umax - y->umax) > MAP_EPS)
+			return x->umax < y->umax ? -1 : 1;
+		return 0;
+	}
+
+	if (fabs(x->umax - y->umax) > MAP_EPS)
+		return x->umax < y->umax ? -1 : 1;
+	if (fabs(x->usq - y->usq) > MAP_EPS)
+		return x->usq < y->usq ? -1 : 1;
+
+	return x->nodes - y->nodes;
+}
+
+int map_cand_cmp(int obj, const struct map_cand *x,
+		 const struct map_cand *y)
+{
+	int c = map_key_cmp(obj, (struct map_key *)&x->key,
+			    (struct map_key *)&y->key);
+
+	if (c)
+		return c;
+	if (x->v != y->v)
+		return x->v - y->v;
+
+	return x->to - y->to;
+}
+
+/* sort() passes no context: one comparator per objective */
+int map_cand_cmp_nodes(const void *a, const void *b)
+{
+	return map_cand_cmp(MAP_NODES, a, b);
+}
+
+int map_cand_cmp_util(const void *a, const void *b)
+{
+	return map_cand_cmp(MAP_UTIL, a, b);
+}
+
+/* key and top nodes of the current mapping, from scratch */
+void map_key_init(struct map *m)
+{
+	int g, k;
+
+	m->key.nodes = 0;
+	m->key.umax = 0.0;
+	m->key.usq = 0.0;
+	m->top[0] = m->top[1] = m->top[2] = -1;
+
+	for (g = 0; g < m->nn; g++) {
+		double u;
+
+		if (m->n[g]->type != CPUNODE || !m->cnt[g])
+			continue;
+
+		u = map_util(m, g, m->load[g]);
+		m->key.nodes++;
+		m->key.usq += u * u;
+		m->key.umax = max(m->key.umax, u);
+
+		for (k = 0; k < 3; k++) {
+			if (m->top[k] < 0 ||
+			    u > map_util(m, m->top[k], m->load[m->top[k]]))
+				break;
+		}
+		if (k < 3) {
+			memmove(&m->top[k + 1], &m->top[k],
+				(2 - k) * sizeof(int));
+			m->top[k] = g;
+		}
+	}
+}
+
+/* key of the mapping with vertex k moved to node b */
+void map_key_move(struct map *m, int k, int b, struct map_key *key)
+{
+	int a = m->cur[k], i;
+	tick_t e = m->v[k]->e;
+	double ua = map_util(m, a, m->load[a]);
+	double ub = map_util(m, b, m->load[b]);
+	double ua2 = map_util(m, a, m->load[a] - e);
+	double ub2 = map_util(m, b, tick_add(m->load[b], e));
+
+	key->nodes = m->key.nodes - (m->cnt[a] == 1) + (m->cnt[b] == 0);
+	key->usq = m->key.usq - ua * ua - ub * ub + ua2 * ua2 + ub2 * ub2;
+
+	key->umax = max(ua2, ub2);
+	for (i = 0; i < 3; i++) {
+		int g = m->top[i];
+
+		if (g >= 0 && g != a && g != b) {
+			key->umax = max(key->umax,
+					map_util(m, g, m->load[g]));
+			break;
+		}
+	}
+}
+
+/*
+ * Moves of CPU vertices to the other CPU nodes of their task, best
+ * first. Pruned without analysis: moves onto a node with more work
+ * than its CPUs can run within the deadline, moves to an empty node
+ * when an earlier empty node of the task has as many CPUs, and, unless
+ * repairing, moves whose mapping is no better than the current one.
+ * Repairs only try the first MAP_REPAIR.
+ */
+int map_cands(struct map *m)
+{
+	struct map_cand *c;
+	int k, g, h, cap = 0;
+
+	m->nc = 0;
+	for (k = 0; k < m->nv; k++) {
+		struct vert *v = m->v[k];
+		struct task *t = v->t;
+
+		if (v->n->type != CPUNODE)
+			continue;
+
+		if (m->repair && m->ref->t[t->id].v[v->id].tard <= 0)
+			continue;
+
+		for (g = 0; g < m->nn; g++) {
+			struct cl_node *n = m->n[g];
+			struct map_key key;
+			tick_t cpu;
+
+			if (m->nt[g] != t->id || g == m->cur[k] ||
+			    n->type != CPUNODE)
+				continue;
+
+			if (!__builtin_mul_overflow(t->d, n->cpus, &cpu) &&
+			    tick_add(m->load[g], v->e) > cpu)
+				continue;
+
+			if (!m->cnt[g]) {
+				for (h = 0; h < g; h++) {
+					if (m->nt[h] == t->id && !m->cnt[h] &&
+					    m->n[h]->type == CPUNODE &&
+					    m->n[h]->cpus == n->cpus)
+						break;
+				}
+				if (h < g)
+					continue;
+			}
+
+			map_key_move(m, k, g, &key);
+			if (!m->repair &&
+			    map_key_cmp(m->obj, &key, &m->key) >= 0)
+				continue;
+
+			if (m->nc == cap) {
+				cap = 2 * cap + 64;
+				c = (struct map_cand *)realloc(m->c,
+							cap * sizeof(*c));
+				if (!c)
+					return 1;
+				m->c = c;
+			}
+
+			m->c[m->nc].v = k;
+			m->c[m->nc].to = g;
+			m->c[m->nc++].key = key;
+		}
+	}
+
+	sort(m->c, m->nc, sizeof(struct map_cand),
+	     m->obj == MAP_NODES ? map_cand_cmp_nodes : map_cand_cmp_util);
+	if (m->repair)
+		m->nc = min(m->nc, MAP_REPAIR);
+
+	free(m->csched);
+	free(m->ctard);
+	m->csched = (int *)malloc(max(m->nc, 1) * sizeof(int));
+	m->ctard = (tick_t *)malloc(max(m->nc, 1) * sizeof(tick_t));
+
+	return !m->csched || !m->ctard;
+}
+
+int map_set(struct map_thread *mt, int k, int g, int *sched)
+{
+	struct taskset *ts = &mt->ts;
+	struct whatif w;
+
+	w.task = mt->m->v[k]->t->id;
+	w.vert = mt->m->v[k]->id;
+	w.what = WHATIF_NODE;
+	w.n = mt->n[g];
+
+	return rta_whatif(ts, &w, sched);
+}
+
+tick_t map_tard(struct taskset *ts)
+{
+	tick_t tard = ts->t[0].tard;
+	int i;
+
+	for (i = 1; i < ts->nt; i++)
+		tard = max(tard, ts->t[i].tard);
+
+	return tard;
+}
+
+/* apply the moves taken since the last step to the copy */
+int map_sync(struct map_thread *mt)
+{
+	struct map *m = mt->m;
+	int sched;
+
+	/* the move left applied is usually the one taken */
+	if (mt->kv >= 0) {
+		if (mt->nmv < m->nmv && m->mv[mt->nmv].v == mt->kv &&
+		    m->mv[mt->nmv].to == mt->kto)
+			mt->nmv++;
+		else if (map_set(mt, mt->kv, mt->kfrom, &sched))
+			return 1;
+		mt->kv = -1;
+	}
+
+	for (; mt->nmv < m->nmv; mt->nmv++) {
+		if (map_set(mt, m->mv[mt->nmv].v, m->mv[mt->nmv].to, &sched))
+			return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * Each candidate is tried on the copy of the thread with an incremental
+ * analysis, and undone with another one unless it improves.
+ */
+void map_step(struct map_thread *mt)
+{
+	struct map *m = mt->m;
+	int i, sched, f;
+
+	if (map_sync(mt))
+		m->err = 1;
+
+	while (!m->err && (i = __sync_fetch_and_add(&m->next, 1)) < m->nc) {
+		struct map_cand *c = &m->c[i];
+
+		/* the candidates after an improving one are worse */
+		if (i > __atomic_load_n(&m->found, __ATOMIC_RELAXED))
+			break;
+
+		if (map_set(mt, c->v, c->to, &m->csched[i])) {
+			m->err = 1;
+			break;
+		}
+		m->ctard[i] = map_tard(&mt->ts);
+
+		if (!m->csched[i] && (!m->repair || m->ctard[i] >= m->tard)) {
+			if (map_set(mt, c->v, m->cur[c->v], &sched)) {
+				m->err = 1;
+				break;
+			}
+			continue;
+		}
+
+		/* no later candidate can win: keep it for the next step */
+		mt->kv = c->v;
+		mt->kto = c->to;
+		mt->kfrom = m->cur[c->v];
+
+		f = __atomic_load_n(&m->found, __ATOMIC_RELAXED);
+		while (i < f &&
+		       !__atomic_compare_exchange_n(&m->found, &f, i, 1,
+						    __ATOMIC_RELAXED,
+						    __ATOMIC_RELAXED))
+			;
+		break;
+	}
+}
+
+/*
+ * The threads other than the caller of rta_map() live through the whole
+ * search, as in rta(): the steps start and end at barriers.
+ */
+void *map_worker(void *arg)
+{
+	struct map_thread *mt = (struct map_thread *)arg;
+	struct map *m = mt->m;
+
+	for (;;) {
+		pthread_barrier_wait(m->bar);
+		if (m->stop)
+			break;
+
+		map_step(mt);
+		pthread_barrier_wait(m->bar);
+	}
+
+	return NULL;
+}
+
+void map_take(struct map *m, int i)
+{
+	struct map_cand *c = &m->c[i];
+	int a = m->cur[c->v];
+	tick_t e = m->v[c->v]->e;
+
+	m->mv[m->nmv].v = c->v;
+	m->mv[m->nmv++].to = c->to;
+	m->nrep += m->repair;
+
+	m->load[a] -= e;
+	m->cnt[a]--;
+	m->load[c->to] = tick_add(m->load[c->to], e);
+	m->cnt[c->to]++;
+	m->cur[c->v] = c->to;
+	map_key_init(m);
+
+	m->sched = m->csched[i];
+	m->tard = m->ctard[i];
+}
+
+/*
+ * No mapping helps a task whose critical path is longer than its
+ * deadline, or whose CPU work is more than all its CPU nodes can run
+ * before it.
+ */
+int map_hopeless(struct taskset *ts)
+{
+	struct cl_node *n;
+	tick_t work, cap;
+	int i, j, cpus;
+
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		if (t->len > t->d)
+			return 1;
+
+		work = 0;
+		for (j = 0; j < t->nv; j++) {
+			if (t->v[j].n->type == CPUNODE)
+				work = tick_add(work, t->v[j].e);
+		}
+
+		cpus = 0;
+		list_for_each_entry(n, &t->nodes, lnode) {
+			if (n->type == CPUNODE)
+				cpus += n->cpus;
+		}
+
+		if (!__builtin_mul_overflow(t->d, cpus, &cap) && work > cap)
+			return 1;
+	}
+
+	return 0;
+}
+
+int map_init(struct map *m, struct taskset *ts, int obj)
+{
+	struct cl_node *n;
+	int i, j, g, k;
+
+	memset(m, 0, sizeof(*m));
+	m->ts = ts;
+	m->obj = obj;
+
+	for (i = 0; i < ts->nt; i++) {
+		m->nv += ts->t[i].nv;
+		list_for_each_entry(n, &ts->t[i].nodes, lnode)
+			m->nn++;
+	}
+
+	m->v = (struct vert **)malloc(m->nv * sizeof(struct vert *));
+	m->cur = (int *)malloc(m->nv * sizeof(int));
+	m->n = (struct cl_node **)malloc(m->nn * sizeof(struct cl_node *));
+	m->nt = (int *)malloc(m->nn * sizeof(int));
+	m->load = (tick_t *)calloc(m->nn, sizeof(tick_t));
+	m->cnt = (int *)calloc(m->nn, sizeof(int));
+	m->mv = (struct map_move *)malloc(MAP_MOVES *
+					  sizeof(struct map_move));
+	if (!m->v || !m->cur || !m->n || !m->nt || !m->load || !m->cnt ||
+	    !m->mv)
+		return 1;
+
+	for (i = 0, g = 0, k = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+		int first = g;
+
+		list_for_each_entry(n, &t->nodes, lnode) {
+			m->n[g] = n;
+			m->nt[g++] = i;
+		}
+
+		for (j = 0; j < t->nv; j++, k++) {
+			int h;
+
+			for (h = first; m->n[h] != t->v[j].n; h++)
+				;
+			m->v[k] = &t->v[j];
+			m->cur[k] = h;
+			m->load[h] = tick_add(m->load[h], t->v[j].e);
+			m->cnt[h]++;
+		}
+	}
+
+	map_key_init(m);
+	return 0;
+}
+
+void map_free(struct map *m)
+{
+	free(m->v);
+	free(m->cur);
+	free(m->n);
+	free(m->nt);
+	free(m->load);
+	free(m->cnt);
+	free(m->mv);
+	free(m->c);
+	free(m->csched);
+	free(m->ctard);
+}
+
+/*
+ * Mapping exploration: move CPU vertices among the CPU nodes of their
+ * task, one vertex per step, towards fewer CPU nodes in use (MAP_NODES)
+ * or a lower utilization of the busiest one (MAP_UTIL), keeping the
+ * taskset schedulable; from an unschedulable mapping, first moving late
+ * vertices while that lowers the largest tardiness. Every step takes
+ * the first candidate, by the mapping it gives, that the RTA accepts;
+ * candidates are evaluated on ts->nth threads, each trying moves on
+ * its own copy of the taskset with incremental analyses (rta_whatif()),
+ * which only redo the interferer tables of the two nodes involved and
+ * the vertices depending on them. I/O vertices stay where they are.
+ * On MAP_FOUND, ts has the new mapping.
+ */
+int rta_map(struct taskset *ts, int obj, int *res)
+{
+	struct map_thread *th;
+	pthread_barrier_t bar;
+	struct map m;
+	int nth, sched, i, k, nrun = 1, ret = 1;
+
+	if (taskset_update(ts))
+		return 1;
+
+	nth = max(ts->nth, 1);
+	th = (struct map_thread *)calloc(nth, sizeof(*th));
+	if (map_init(&m, ts, obj) || !th)
+		goto out;
+
+	for (k = 0; k < nth; k++) {
+		struct map_thread *mt = &th[k];
+		struct cl_node *n;
+		int g = 0;
+
+		mt->m = &m;
+		mt->kv = -1;
+		if (taskset_clone(&mt->ts, ts)) {
+			mt->m = NULL;
+			goto out;
+		}
+		mt->ts.nth = 1;
+		mt->ts.solver = SOLVER_SWEEP;
+
+		mt->n = (struct cl_node **)malloc(m.nn *
+						  sizeof(struct cl_node *));
+		if (!mt->n)
+			goto out;
+		for (i = 0; i < mt->ts.nt; i++)
+			list_for_each_entry(n, &mt->ts.t[i].nodes, lnode)
+				mt->n[g++] = n;
+
+		if (rta(&mt->ts, &sched))
+			goto out;
+	}
+	m.ref = &th[0].ts;
+	m.sched = sched;
+	m.tard = map_tard(m.ref);
+
+	if (pthread_barrier_init(&bar, NULL, nth))
+		goto out;
+	m.bar = &bar;
+
+	for (; nrun < nth; nrun++) {
+		if (pthread_create(&th[nrun].tid, NULL, map_worker,
+				   &th[nrun]))
+			err_exit("ERROR creating mapping thread\n");
+	}
+
+	while (m.nmv < MAP_MOVES &&
+	       (m.sched || (m.nrep < MAP_REPAIR_MOVES && !map_hopeless(ts)))) {
+		m.repair = !m.sched;
+		if (map_sync(&th[0]) || map_cands(&m))
+			goto out;
+
+		m.next = 0;
+		m.found = m.nc;
+
+		pthread_barrier_wait(&bar);
+		map_step(&th[0]);
+		pthread_barrier_wait(&bar);
+
+		if (m.err)
+			goto out;
+
+		if (m.found == m.nc)
+			break;
+		map_take(&m, m.found);
+	}
+
+	*res = m.sched ? MAP_FOUND : MAP_NOT_FOUND;
+	if (m.sched) {
+		for (k = 0; k < m.nv; k++) {
+			struct vert *v = m.v[k];
+
+			if (v->n != m.n[m.cur[k]] &&
+			    task_set_node(v->t, v->id, m.n[m.cur[k]]))
+				goto out;
+		}
+	}
+
+	ret = 0;
+out:
+	if (m.bar) {
+		m.stop = 1;
+		pthread_barrier_wait(&bar);
+		for (k = 1; k < nrun; k++)
+			pthread_join(th[k].tid, NULL);
+		pthread_barrier_destroy(&bar);
+	}
+
+	for (k = 0; k < nth && th; k++) {
+		if (th[k].m) {
+			if (!ret)
+				rta_stats_merge(ts, &th[k].ts);
+			taskset_finalize(&th[k].ts);
+		}
+		free(th[k].n);
+	}
+	free(th);
+	map_free(&m);
+	return ret;
+}
+
+/*
+ * CPU nodes in use and their largest utilization, node[] if given. The
+ * WCETs on each node of a task add up in load[], by position in the
+ * node list of the task, -1 for a node hosting no vertex.
+ */
+int map_stat(struct taskset *ts, struct cl_node **node, int *nodes,
+	     double *umax)
+{
+	struct cl_node *n, *vn;
+	tick_t *load = NULL, *tmp;
+	int i, j, g, nn, cap = 0, k = 0;
+
+	*nodes = 0;
+	*umax = 0.0;
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		nn = 0;
+		list_for_each_entry(n, &t->nodes, lnode)
+			nn++;
+
+		if (nn > cap) {
+			tmp = (tick_t *)realloc(load, nn * sizeof(tick_t));
+			if (!tmp) {
+				free(load);
+				return 1;
+			}
+			load = tmp;
+			cap = nn;
+		}
+
+		for (g = 0; g < nn; g++)
+			load[g] = -1;
+		for (j = 0; j < t->nv; j++, k++) {
+			vn = node ? node[k] : t->v[j].n;
+
+			g = 0;
+			list_for_each_entry(n, &t->nodes, lnode) {
+				if (n == vn)
+					break;
+				g++;
+			}
+			load[g] = tick_add(max(load[g], 0), t->v[j].e);
+		}
+
+		g = 0;
+		list_for_each_entry(n, &t->nodes, lnode) {
+			if (n->type == CPUNODE && load[g] >= 0) {
+				(*nodes)++;
+				*umax = max(*umax, (double)load[g] /
+					    ((double)t->p * n->cpus));
+			}
+			g++;
+		}
+	}
+
+	free(load);
+	return 0;
+}
+
+/* from: node of every vertex, in task order, before rta_map() */
+int map_print(struct taskset *ts, struct cl_node **from, int res,
+	      int obj)
+{
+	int nodes[2], i, j, k, nmv = 0;
+	double umax[2];
+
+	printf("Mapping (%s): %s\n", obj == MAP_NODES ? "fewest nodes" :
+		"lowest max. utilization", res == MAP_FOUND ? "found" :
+		"none found");
+	if (res != MAP_FOUND) {
+		printf("\n");
+		return 0;
+	}
+
+	if (map_stat(ts, from, &nodes[0], &umax[0]) ||
+	    map_stat(ts, NULL, &nodes[1], &umax[1]))
+		return 1;
+
+	printf("\tCPU nodes in use: %d -> %d,  max. utilization:"
+		" %.2f -> %.2f\n", nodes[0], nodes[1], umax[0], umax[1]);
+
+	for (i = 0, k = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		for (j = 0; j < t->nv; j++, k++) {
+			if (t->v[j].n == from[k])
+				continue;
+
+			printf("\tTASK %d chunk %s[%d]: %s -> %s\n", t->id,
+				t->v[j].name, j, from[k]->name,
+				t->v[j].n->name);
+			nmv++;
+		}
+	}
+	printf("\t%d chunks moved\n\n", nmv);
+	return 0;
+}
+
+#define SLACK_SCALE_EPS	0.0001	/* resolution of the scaling factor	*/
+
+struct slack {
+	struct taskset *ts;	/* analysed taskset			*/
+	int next;		/* next job: 0 is the scaling factor,	*/
+	int nj;			/* then one per vertex in task order	*/
+
+	tick_t *wcet;		/* per vertex, max WCET or -1 if none	*/
+	double scale;		/* critical scaling factor		*/
+	int err;
+};
+
+struct slack_thread {
+	struct slack *s;
+	struct taskset ts;	/* private copy probed by this thread	*/
+	int sched;		/* verdict with the given WCETs		*/
+
+	tick_t *base;		/* trajectory with the given WCETs	*/
+	int nbase;
+	tick_t *buf[2];		/* trajectories of the current search	*/
+
+	pthread_t tid;
+};
+
+/*
+ * One probe: analyse with the current WCETs, starting every round from
+ * the trajectory *warm of *nwarm rounds if any. On success the new
+ * trajectory replaces the warm one.
+ */
+int slack_probe(struct slack_thread *st, tick_t **warm, int *nwarm,
+		int *sched)
+{
+	struct taskset *ts = &st->ts;
+	tick_t *traj = (*warm == st->buf[0]) ? st->buf[1] : st->buf[0];
+
+	ts->warm = *warm;
+	ts->nwarm = *warm ? *nwarm : 0;
+	ts->traj = traj;
+
+	if (rta(ts, sched))
+		return 1;
+
+	ts->warm = NULL;
+	ts->nwarm = 0;
+	ts->traj = NULL;
+
+	if (*sched) {
+		*warm = traj;
+		*nwarm = min(ts->nr, XI);
+	}
+
+	return 0;
+}
+
+/* only the edited vertex and the same-node vertices reaching it change */
+int slack_set_wcet(struct taskset *ts, struct vert *v, tick_t e)
+{
+	struct cl_node *n = v->n;
+	tick_t de = e - v->e;
+	int k;
+
+	if (task_set_wcet(v->t, v->id, e) || taskset_update(ts))
+		return 1;
+
+	/* v interferes with the vertices of priority <= v->prio */
+	for (k = n->niv - 1; n->type == CPUNODE && k >= 0; k--) {
+		struct vert *u = n->iv[k];
+
+		if (u->prio > v->prio)
+			break;
+
+		if (u->t == v->t && u != v && task_reachable(v->t, u, v))
+			u->sub += de;
+	}
+
+	ts->dirty = 0;
+	return 0;
+}
+
+/*
+ * Largest WCET of v that keeps the taskset schedulable, by bisection
+ * between a schedulable and an unschedulable value: no larger than what
+ * makes the critical path through v exceed the deadline.
+ */
+int slack_vert(struct slack_thread *st, struct vert *v, tick_t *wcet)
+{
+	tick_t e = v->e, lo, hi, mid, *warm = st->base;
+	int nwarm = st->nbase, sched;
+
+	if (st->sched) {
+		lo = e;
+		hi = v->t->d - (v->l_to + v->l_from - 2 * e) + 1;
+	} else {
+		warm = NULL;
+		if (slack_set_wcet(&st->ts, v, 1) ||
+		    slack_probe(st, &warm, &nwarm, &sched))
+			return 1;
+
+		lo = sched ? 1 : -1;
+		hi = e;
+	}
+
+	while (lo > 0 && hi - lo > 1) {
+		mid = lo + (hi - lo) / 2;
+
+		if (slack_set_wcet(&st->ts, v, mid) ||
+		    slack_probe(st, &warm, &nwarm, &sched))
+			return 1;
+
+		if (sched)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	*wcet = lo;
+	return slack_set_wcet(&st->ts, v, e);
+}
+
+/* scale is at most (D + 1) / len, so no scaled WCET exceeds D + 1 */
+int slack_scale_set(struct taskset *ts, tick_t *e, double scale)
+{
+	tick_t w;
+	int i, j, k = 0;
+
+	for (i = 0; i < ts->nt; i++) {
+		for (j = 0; j < ts->t[i].nv; j++, k++) {
+			w = (tick_t)max(ceil(scale * e[k]), 1.0);
+			if (task_set_wcet(&ts->t[i], j, min(w, TICK_MAX)))
+				return 1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Largest factor all WCETs can be scaled by (rounding up) keeping the
+ * taskset schedulable, to SLACK_SCALE_EPS, or -1 if none does.
+ */
+int slack_scale(struct slack_thread *st, double *scale)
+{
+	struct taskset *ts = &st->ts;
+	double lo, hi, mid;
+	tick_t *e, *warm = st->base;
+	int nwarm = st->nbase, sched, i, j, k = 0, ret = 1;
+
+	e = (tick_t *)malloc(ts->nv * sizeof(tick_t));
+	if (!e)
+		return 1;
+
+	hi = 0.0;
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		for (j = 0; j < t->nv; j++)
+			e[k++] = t->v[j].e;
+
+		if (hi == 0.0 || (double)(t->d + 1) / t->len < hi)
+			hi = (double)(t->d + 1) / t->len;
+	}
+
+	if (st->sched) {
+		lo = 1.0;
+	} else {
+		warm = NULL;
+		if (slack_scale_set(ts, e, 0.0) ||
+		    slack_probe(st, &warm, &nwarm, &sched))
+			goto out;
+
+		lo = sched ? 0.0 : -1.0;
+		hi = 1.0;
+	}
+
+	while (lo >= 0.0 && hi - lo > SLACK_SCALE_EPS) {
+		mid = (lo + hi) / 2.0;
+
+		if (slack_scale_set(ts, e, mid) ||
+		    slack_probe(st, &warm, &nwarm, &sched))
+			goto out;
+
+		if (sched)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	*scale = lo;
+	ret = slack_scale_set(ts, e, 1.0) || taskset_update(ts) ||
+	      rta_prepare(ts);
+out:
+	free(e);
+	return ret;
+}
+
+void *slack_worker(void *arg)
+{
+	struct slack_thread *st = (struct slack_thread *)arg;
+	struct slack *s = st->s;
+	int j, i, k;
+
+	while (!s->err && (j = __sync_fetch_and_add(&s->next, 1)) < s->nj) {
+		if (j == 0) {
+			if (slack_scale(st, &s->scale))
+				s->err = 1;
+			continue;
+		}
+
+		for (i = 0, k = j - 1; k >= st->ts.t[i].nv; i++)
+			k -= st->ts.t[i].nv;
+
+		if (slack_vert(st, &st->ts.t[i].v[k], &s->wcet[j - 1]))
+			s->err = 1;
+	}
+
+	return NULL;
+}
+
+/*
+ * Slack table: for every vertex the largest WCET that keeps the taskset
+ * schedulable, the others unchanged, and the critical scaling factor of
+ * all WCETs. Each bisection is a job for one of ts->nth threads, every
+ * thread probing its own copy of the taskset; each probe starts from
+ * the trajectory of the largest schedulable WCETs found so far.
+ */
+int rta_slack(struct taskset *ts, tick_t **wcet, double *scale)
+{
+	struct slack_thread *th;
+	struct slack s;
+	int nth, i, k;
+
+	if (!ts || taskset_update(ts))
+		return 1;
+
+	memset(&s, 0, sizeof(s));
+	s.ts = ts;
+	for (i = 0; i < ts->nt; i++)
+		s.nj += ts->t[i].nv;
+	s.nj++;
+
+	nth = min(max(ts->nth, 1), s.nj);
+	th = (struct slack_thread *)calloc(nth, sizeof(*th));
+	s.wcet = (tick_t *)malloc(s.nj * sizeof(tick_t));
+	if (!th || !s.wcet)
+		goto err;
+
+	for (k = 0; k < nth; k++) {
+		struct slack_thread *st = &th[k];
+		size_t len = (size_t)XI * (s.nj - 1) * sizeof(tick_t);
+
+		st->s = &s;
+		if (taskset_clone(&st->ts, ts)) {
+			s.err = 1;
+			break;
+		}
+		st->ts.nth = 1;
+		st->ts.solver = SOLVER_SWEEP;
+
+		st->base = (tick_t *)malloc(len);
+		st->buf[0] = (tick_t *)malloc(len);
+		st->buf[1] = (tick_t *)malloc(len);
+		if (!st->base || !st->buf[0] || !st->buf[1]) {
+			s.err = 1;
+			break;
+		}
+
+		/* copies analyse alike: one baseline serves them all */
+		if (k > 0) {
+			memcpy(st->base, th[0].base, len);
+			st->nbase = th[0].nbase;
+			st->sched = th[0].sched;
+
+			if (rta_prepare(&st->ts)) {
+				s.err = 1;
+				break;
+			}
+			continue;
+		}
+
+		st->ts.traj = st->base;
+		if (rta(&st->ts, &st->sched)) {
+			s.err = 1;
+			break;
+		}
+		st->ts.traj = NULL;
+		st->nbase = min(st->ts.nr, XI);
+	}
+
+	if (!s.err) {
+		for (k = 1; k < nth; k++) {
+			if (pthread_create(&th[k].tid, NULL, slack_worker,
+					   &th[k]))
+				err_exit("ERROR creating slack thread\n");
+		}
+
+		slack_worker(&th[0]);
+
+		for (k = 1; k < nth; k++)
+			pthread_join(th[k].tid, NULL);
+	}
+
+	for (k = 0; k < nth; k++) {
+		if (th[k].s) {
+			if (!s.err)
+				rta_stats_merge(ts, &th[k].ts);
+			taskset_finalize(&th[k].ts);
+		}
+		free(th[k].base);
+		free(th[k].buf[0]);
+		free(th[k].buf[1]);
+	}
+	free(th);
+
+	if (s.err)
+		goto err;
+
+	*wcet = s.wcet;
+	*scale = s.scale;
+	return 0;
+err:
+	free(s.wcet);
+	return 1;
+}
+
+int slack_print(struct taskset *ts, tick_t *wcet, double scale)
+{
+	int i, j, k = 0;
+
+	printf("********************************************************"
+		"*******************\n");
+	if (scale < 0)
+		printf("   WCET SLACK   (no scaling factor is schedulable)\n");
+	else
+		printf("   WCET SLACK   (critical scaling factor = %.4f)\n",
+			scale);
+	printf("********************************************************"
+		"*******************\n");
+
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		printf("\n%10s %d:\n\n", "TASK", t->id);
+		printf("               vertex     exec.time      max.wcet     "
+			"    slack\n");
+
+		for (j = 0; j < t->nv; j++, k++) {
+			if (wcet[k] < 0) {
+				printf("%21d%14.*f%14s%14s\n", j, tick_prec,
+					tick_unit(t->v[j].e), "-", "-");
+				continue;
+			}
+
+			printf("%21d%14.*f%14.*f%14.*f\n", j, tick_prec,
+				tick_unit(t->v[j].e), tick_prec,
+				tick_unit(wcet[k]), tick_prec,
+				tick_unit(wcet[k] - t->v[j].e));
+		}
+
+		printf("\n---------------------------------------------------"
+			"------------------------\n");
+	}
+
+	return 0;
+}
+
+#define MC_CHUNK	64	/* samples a thread takes at a time	*/
+
+/*
+ * Monte Carlo response times: every sample draws the execution time of
+ * each vertex and runs the RTA on it. With probability prob it follows
+ * the triangular distribution over [best, e] peaking at value, else it
+ * overruns e, uniformly by up to e - best (at least one tick).
+ */
+struct mc {
+	struct taskset *ts;	/* analysed taskset			*/
+	long n;			/* samples				*/
+	uint64_t seed;
+	long next;		/* next sample to take			*/
+
+	struct vert **v;	/* all vertices, in task order		*/
+	int nv;
+	int *sub_off;		/* vertices whose e vertex i discounts	*/
+	int *sub;		/* as sub (see node_prepare()), in CSR	*/
+
+	int err;
+};
+
+/*
+ * Response times of one task, as an exact histogram: distinct values
+ * and how many samples gave each, in an open-addressing table (linear
+ * probing, at most half full), so memory follows the values seen and
+ * not the samples.
+ */
+struct mc_bin {
+	tick_t v;
+	long n;			/* samples, 0 for a free slot		*/
+};
+
+struct mc_hist {
+	struct mc_bin *b;
+	size_t cap;		/* slots, a power of two		*/
+	size_t used;
+};
+
+struct mc_thread {
+	struct mc *m;
+	struct taskset ts;	/* private copy analysed by this thread	*/
+	struct vert **v;	/* its vertices, in task order		*/
+
+	struct mc_hist *h;	/* per task, of its samples		*/
+	long any;		/* its samples where some task missed	*/
+
+	pthread_t tid;
+};
+
+int mc_hist_add(struct mc_hist *h, tick_t v, long n)
+{
+	struct mc_bin *b;
+	size_t i, k, cap;
+
+	if (2 * (h->used + 1) > h->cap) {
+		cap = h->cap ? 2 * h->cap : 64;
+		b = (struct mc_bin *)calloc(cap, sizeof(struct mc_bin));
+		if (!b)
+			return 1;
+
+		for (k = 0; k < h->cap; k++) {
+			if (!h->b[k].n)
+				continue;
+			i = ((uint64_t)h->b[k].v * 0x9e3779b97f4a7c15ULL) &
+			    (cap - 1);
+			while (b[i].n)
+				i = (i + 1) & (cap - 1);
+			b[i] = h->b[k];
+		}
+
+		free(h->b);
+		h->b = b;
+		h->cap = cap;
+	}
+
+	i = ((uint64_t)v * 0x9e3779b97f4a7c15ULL) & (h->cap - 1);
+	while (h->b[i].n && h->b[i].v != v)
+		i = (i + 1) & (h->cap - 1);
+
+	if (!h->b[i].n) {
+		h->b[i].v = v;
+		h->used++;
+	}
+	h->b[i].n += n;
+	return 0;
+}
+
+/* adds every bin of h to dst */
+int mc_hist_merge(struct mc_hist *dst, struct mc_hist *h)
+{
+	size_t k;
+
+	for (k = 0; k < h->cap; k++) {
+		if (h->b[k].n && mc_hist_add(dst, h->b[k].v, h->b[k].n))
+			return 1;
+	}
+
+	return 0;
+}
+
+void mc_hist_free(struct mc_hist *h, int nt)
+{
+	int j;
+
+	for (j = 0; h && j < nt; j++)
+		free(h[j].b);
+	free(h);
+}
+
+/* splitmix64; every sample has its own stream, whatever the threads */
+uint64_t mc_next(uint64_t *s)
+{
+	uint64_t z = (*s += 0x9e3779b97f4a7c15ULL);
+
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+	return z ^ (z >> 31);
+}
+
+/* uniform in [0, 1) */
+double mc_uniform(uint64_t *s)
+{
+	return (mc_next(s) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+tick_t mc_draw(struct vert *v, uint64_t *s)
+{
+	double u = mc_uniform(s), b, m, w, x;
+
+	if (mc_uniform(s) >= v->prob)
+		return tick_add(v->e, 1 + (tick_t)(u * max(v->e - v->best,
+							   1)));
+
+	if (v->best >= v->e)
+		return v->e;
+
+	b = v->best;
+	m = v->value;
+	w = v->e;
+	if (u < (m - b) / (w - b))
+		x = b + sqrt(u * (w - b) * (m - b));
+	else
+		x = w - sqrt((1.0 - u) * (w - b) * (w - m));
+
+	x = ceil(x);
+	if (x < b)
+		return v->best;
+	if (x > w)
+		return v->e;
+	return (tick_t)x;
+}
+
+int mc_sample(struct mc_thread *mt, long i)
+{
+	struct mc *m = mt->m;
+	struct taskset *ts = &mt->ts;
+	uint64_t s = i;
+	int k, j, sched;
+
+	s = mc_next(&s) ^ m->seed;
+
+	for (k = 0; k < m->nv; k++)
+		mt->v[k]->e = mc_draw(m->v[k], &s);
+
+	/* rta() sees no edit: the interferers stay, sub is redone here */
+	for (k = 0; k < m->nv; k++) {
+		mt->v[k]->sub = 0;
+		for (j = m->sub_off[k]; j < m->sub_off[k + 1]; j++)
+			mt->v[k]->sub = tick_add(mt->v[k]->sub,
+						 mt->v[m->sub[j]]->e);
+	}
+
+	if (rta(ts, &sched))
+		return 1;
+
+	for (k = 0, j = 0; k < ts->nt; k++) {
+		if (mc_hist_add(&mt->h[k], ts->t[k].resp, 1))
+			return 1;
+		j |= ts->t[k].resp > ts->t[k].d;
+	}
+	mt->any += j;
+
+	return 0;
+}
+
+void *mc_worker(void *arg)
+{
+	struct mc_thread *mt = (struct mc_thread *)arg;
+	struct mc *m = mt->m;
+	long i, lo;
+
+	while (!__atomic_load_n(&m->err, __ATOMIC_RELAXED) &&
+	       (lo = __sync_fetch_and_add(&m->next, MC_CHUNK)) < m->n) {
+		for (i = lo; i < m->n && i < lo + MC_CHUNK; i++) {
+			if (mc_sample(mt, i)) {
+				__atomic_store_n(&m->err, 1, __ATOMIC_RELAXED);
+				break;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/* the vertices of ts in task order, and for each those it discounts */
+int mc_prepare(struct mc *m, struct taskset *ts)
+{
+	int i, j, k, nsub = 0, cap = 0, *tmp, *off;
+
+	m->nv = 0;
+	for (i = 0; i < ts->nt; i++)
+		m->nv += ts->t[i].nv;
+
+	m->v = (struct vert **)malloc(m->nv * sizeof(struct vert *));
+	m->sub_off = (int *)malloc((m->nv + 1) * sizeof(int));
+	off = (int *)malloc(ts->nt * sizeof(int));
+	if (!m->v || !m->sub_off || !off)
+		goto err;
+
+	for (i = 0, k = 0; i < ts->nt; i++) {
+		off[i] = k;
+		for (j = 0; j < ts->t[i].nv; j++)
+			m->v[k++] = &ts->t[i].v[j];
+	}
+
+	for (k = 0; k < m->nv; k++) {
+		struct vert *v = m->v[k];
+
+		m->sub_off[k] = nsub;
+		for (j = 0; v->n->type == CPUNODE && j < v->ni; j++) {
+			struct vert *vi = v->n->iv[j];
+
+			if (vi->t != v->t || vi == v ||
+			    !task_reachable(v->t, v, vi))
+				continue;
+
+			if (nsub == cap) {
+				cap = cap ? 2 * cap : 64;
+				tmp = (int *)realloc(m->sub, cap * sizeof(int));
+				if (!tmp)
+					goto err;
+				m->sub = tmp;
+			}
+			m->sub[nsub++] = off[vi->t->id] + vi->id;
+		}
+	}
+	m->sub_off[m->nv] = nsub;
+
+	free(off);
+	return 0;
+err:
+	free(off);
+	return 1;
+}
+
+/*
+ * Response times of n samples of the execution times: *hist gets one
+ * histogram per task and *any the samples where some task missed its
+ * deadline. Samples are handed out in chunks to ts->nth threads, each
+ * analysing its own copy of the taskset into its own histograms; their
+ * sums do not depend on the number of threads.
+ */
+int rta_montecarlo(struct taskset *ts, long n, uint64_t seed,
+		   struct mc_hist **hist, long *any)
+{
+	struct mc_thread *th;
+	struct mc m;
+	int nth, i, k;
+
+	if (!ts || n < 1 || taskset_update(ts) ||
+	    (ts->dirty && rta_prepare(ts)))
+		return 1;
+
+	memset(&m, 0, sizeof(m));
+	m.ts = ts;
+	m.n = n;
+	m.seed = seed;
+
+	nth = max(ts->nth, 1);
+	if (nth > (n + MC_CHUNK - 1) / MC_CHUNK)
+		nth = (n + MC_CHUNK - 1) / MC_CHUNK;
+
+	th = (struct mc_thread *)calloc(nth, sizeof(*th));
+	if (!th || mc_prepare(&m, ts))
+		m.err = 1;
+
+	for (k = 0; k < nth && !m.err; k++) {
+		struct mc_thread *mt = &th[k];
+
+		mt->m = &m;
+		if (taskset_clone(&mt->ts, ts)) {
+			m.err = 1;
+			break;
+		}
+		mt->ts.nth = 1;
+		mt->ts.solver = ts->solver;
+
+		mt->v = (struct vert **)malloc(m.nv * sizeof(struct vert *));
+		mt->h = (struct mc_hist *)calloc(ts->nt,
+						 sizeof(struct mc_hist));
+		if (!mt->v || !mt->h || taskset_update(&mt->ts) ||
+		    rta_prepare(&mt->ts)) {
+			m.err = 1;
+			break;
+		}
+
+		for (i = 0; i < m.nv; i++)
+			mt->v[i] = &mt->ts.t[m.v[i]->t->id].v[m.v[i]->id];
+	}
+
+	if (!m.err) {
+		for (k = 1; k < nth; k++) {
+			if (pthread_create(&th[k].tid, NULL, mc_worker,
+					   &th[k]))
+				err_exit("ERROR creating Monte Carlo thread\n");
+		}
+
+		mc_worker(&th[0]);
+
+		for (k = 1; k < nth; k++)
+			pthread_join(th[k].tid, NULL);
+	}
+
+	/* thread 0 collects the samples of the others */
+	for (k = 1; k < nth && !m.err; k++) {
+		th[0].any += th[k].any;
+		for (i = 0; i < ts->nt && !m.err; i++)
+			m.err = mc_hist_merge(&th[0].h[i], &th[k].h[i]);
+	}
+
+	if (!m.err) {
+		*hist = th[0].h;
+		*any = th[0].any;
+		th[0].h = NULL;
+	}
+
+	for (k = 0; th && k < nth; k++) {
+		if (th[k].m) {
+			if (!m.err)
+				rta_stats_merge(ts, &th[k].ts);
+			taskset_finalize(&th[k].ts);
+		}
+		free(th[k].v);
+		mc_hist_free(th[k].h, ts->nt);
+	}
+	free(th);
+	free(m.v);
+	free(m.sub_off);
+	free(m.sub);
+
+	return m.err;
+}
+
+int mc_bin_cmp(const void *a, const void *b)
+{
+	tick_t x = ((const struct mc_bin *)a)->v;
+	tick_t y = ((const struct mc_bin *)b)->v;
+
+	return (x > y) - (x < y);
+}
+
+/* percentiles by nearest rank; sorts the bins of every histogram */
+int montecarlo_print(struct taskset *ts, long n, uint64_t seed,
+		     struct mc_hist *hist, long any)
+{
+	static const double q[] = { 0.5, 0.9, 0.99, 0.999, 1.0 };
+	long i, miss, rank;
+	size_t b, u;
+	int j, k;
+
+	printf("********************************************************"
+		"*******************\n");
+	printf("   MONTE CARLO   (%ld samples, seed %" PRIu64
+		", P(any miss) = %.6f)\n", n, seed, (double)any / n);
+	printf("********************************************************"
+		"*******************\n\n");
+
+	printf("%10s%11s%11s%11s%11s%11s%11s\n", "task", "p50", "p90",
+		"p99", "p99.9", "max", "P(miss)");
+
+	for (j = 0; j < ts->nt; j++) {
+		struct mc_bin *r = hist[j].b;
+
+		for (b = 0, u = 0; b < hist[j].cap; b++) {
+			if (r[b].n)
+				r[u++] = r[b];
+		}
+		sort(r, u, sizeof(struct mc_bin), mc_bin_cmp);
+
+		for (miss = 0, b = u; b > 0 && r[b - 1].v > ts->t[j].d; b--)
+			miss += r[b - 1].n;
+
+		printf("%10d", ts->t[j].id);
+		for (k = 0, b = 0, i = r[0].n; k < 5; k++) {
+			rank = max((long)ceil(q[k] * n), 1);
+			while (i < rank)
+				i += r[++b].n;
+			printf("%11.*f", tick_prec, tick_unit(r[b].v));
+		}
+		printf("%11.6f\n", (double)miss / n);
+	}
+
+	printf("\n---------------------------------------------------"
+		"------------------------\n");
+	return 0;
+}
+
+void usage(void)
+{
+	err_exit("Usage: dag [-j threads] [-s sweep|worklist] [-r ticks]"
+		 " [-x rounds] [--exact] [--warm file] [--save-bounds file]"
+		 " [-w task:vertex:wcet|prio|node=value]..."
+		 " [-a [-o out] | -m nodes|util [-o out]] [-S]"
+		 " [-M samples [--seed n]] [--format=text]"
+		 " [--quiet|--summary|--top k]"
+		 " [--stats[=table|json]] <file.xml|file.rtsb>\n"
+		 "       dag --format=json|csv [-j threads]"
+		 " [-s sweep|worklist] [-r ticks] [-x rounds] [--exact]"
+		 " [--warm file] [--save-bounds file]"
+		 " [-w task:vertex:wcet|prio|node=value]..."
+		 " [--quiet|--summary|--top k] [--stats[=table|json]]"
+		 " <file.xml|file.rtsb>\n"
+		 "       dag --verdict-only [-j threads] [-s sweep|worklist]"
+		 " [-r ticks] [-x rounds] [--exact] [--warm file]"
+		 " [--save-bounds file] [--stats[=table|json]]"
+		 " <file.xml|file.rtsb>\n"
+		 "       dag compile [-r ticks] <file.xml> -o <file.rtsb>\n"
+		 "       dag batch [-j threads] [-s sweep|worklist]"
+		 " [-r ticks] [-x rounds] [--exact] <directory|manifest>\n"
+		 "       dag serve [-j threads] [-s sweep|worklist]"
+		 " [-r ticks] [-x rounds] [--exact] <socket>\n");
+}
+
+int compile(int argc, char **argv)
+{
+	static struct option opts[] = {
+		{ "output",	required_argument,	NULL, 'o' },
+		{ "resolution",	required_argument,	NULL, 'r' },
+		{ NULL,		0,			NULL, 0 }
+	};
+	struct taskset ts;
+	char *out = NULL;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "o:r:", opts, NULL)) != -1) {
+		switch (opt) {
+		case 'o':
+			out = optarg;
+			break;
+		case 'r':
+			if (tick_set_res(atoll(optarg)))
+				usage();
+			break;
+		default:
+			usage();
+		}
+	}
+
+	if (!out || optind != argc - 1)
+		usage();
+
+	if (taskset_parse(&ts, argv[optind]))
+		err_exit("ERROR parsing XML file %s\n", argv[optind]);
+
+	if (taskset_write(&ts, out))
+		err_exit("ERROR writing compiled model %s\n", out);
+
+	if (taskset_finalize(&ts))
+		err_exit("taskset_finalize\n");
+
+	return 0;
+}
+
+#define VERDICT_ERROR	0
+#define VERDICT_SCHED	1
+#define VERDICT_UNSCHED	2
+struct batch_res {
+	int done;		/* result ready to be reported		*/
+	int verdict;		/* VERDICT_*				*/
+	int nt;			/* number of tasks			*/
+	int nv;			/* number of vertices			*/
+	double u;		/* utilization				*/
+	tick_t tard;		/* max tardiness over tasks		*/
+	double ms;		/* load and analysis time		*/
+};
+
+struct batch {
+	char **file;		/* models, in reporting order		*/
+	int nf;
+	struct batch_res *res;
+
+	int next;		/* next model to analyse		*/
+	int out;		/* next model to report			*/
+	pthread_mutex_t lock;
+
+	int solver;
+	int rounds;		/* --max-rounds and --exact		*/
+	int exact;
+	int cnt[3];		/* models per verdict			*/
+};
+
+double elapsed_ms(struct timespec *from)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - from->tv_sec) * 1e3 +
+	       (now.tv_nsec - from->tv_nsec) / 1e6;
+}
+
+void batch_report(struct batch *b, int i)
+{
+	static const char *verdict[] = {
+		"error", "schedulable", "unschedulable"
+	};
+	struct batch_res *r = &b->res[i];
+
+	if (r->verdict == VERDICT_ERROR) {
+		printf("%s\terror\t-\t-\t-\t-\t%.3f\n", b->file[i], r->ms);
+		return;
+	}
+
+	printf("%s\t%s\t%d\t%d\t%.2f\t%.*f\t%.3f\n", b->file[i],
+		verdict[r->verdict], r->nt, r->nv, r->u, tick_prec,
+		tick_unit(r->tard), r->ms);
+}
+
+void batch_analyse(struct batch *b, int i)
+{
+	struct batch_res *r = &b->res[i];
+	struct timespec start;
+	struct taskset ts;
+	int sched, k;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	r->verdict = VERDICT_ERROR;
+	if (taskset_load(&ts, b->file[i]) == 0) {
+		ts.solver = b->solver;
+		ts.rounds = b->rounds;
+		ts.exact = b->exact;
+
+		if (rta(&ts, &sched) == 0) {
+			r->verdict = sched ? VERDICT_SCHED : VERDICT_UNSCHED;
+			r->nt = ts.nt;
+			r->nv = ts.nv;
+			r->u = ts.u;
+
+			r->tard = ts.t[0].tard;
+			for (k = 1; k < ts.nt; k++)
+				r->tard = max(r->tard, ts.t[k].tard);
+		}
+
+		taskset_finalize(&ts);
+	}
+
+	r->ms = elapsed_ms(&start);
+}
+
+void *batch_worker(void *arg)
+{
+	struct batch *b = arg;
+	int i;
+
+	while ((i = __sync_fetch_and_add(&b->next, 1)) < b->nf) {
+		batch_analyse(b, i);
+
+		/* report in order, as soon as all earlier models are done */
+		pthread_mutex_lock(&b->lock);
+		b->res[i].done = 1;
+		b->cnt[b->res[i].verdict]++;
+		while (b->out < b->nf && b->res[b->out].done)
+			batch_report(b, b->out++);
+		fflush(stdout);
+		pthread_mutex_unlock(&b->lock);
+	}
+
+	return NULL;
+}
+
+int batch_add(struct batch *b, const char *file, int *cap)
+{
+	char **tmp;
+
+	if (b->nf == *cap) {
+		tmp = (char **)realloc(b->file,
+				       (*cap ? 2 * *cap : 64) * sizeof(char *));
+		if (!tmp)
+			return 1;
+		b->file = tmp;
+		*cap = *cap ? 2 * *cap : 64;
+	}
+
+	b->file[b->nf] = strdup(file);
+	if (!b->file[b->nf])
+		return 1;
+
+	b->nf++;
+	return 0;
+}
+
+int file_cmp(const void *a, const void *b)
+{
+	return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/* every .xml and .rtsb file of a directory, else the lines of a manifest */
+int batch_list(struct batch *b, const char *path)
+{
+	char *line = NULL, *file;
+	struct dirent *de;
+	size_t len = 0;
+	int cap = 0, ret = 0;
+	struct stat st;
+	FILE *f;
+	DIR *d;
+
+	if (stat(path, &st))
+		return 1;
+
+	if (S_ISDIR(st.st_mode)) {
+		d = opendir(path);
+		if (!d)
+			return 1;
+
+		while (!ret && (de = readdir(d))) {
+			char *ext = strrchr(de->d_name, '.');
+
+			if (!ext ||
+			    (strcmp(ext, ".xml") && strcmp(ext, ".rtsb")))
+				continue;
+
+			file = (char *)malloc(strlen(path) +
+					      strlen(de->d_name) + 2);
+			if (!file) {
+				ret = 1;
+				break;
+			}
+
+			sprintf(file, "%s/%s", path, de->d_name);
+			ret = batch_add(b, file, &cap);
+			free(file);
+		}
+
+		closedir(d);
+		sort(b->file, b->nf, sizeof(char *), file_cmp);
+		return ret;
+	}
+
+	f = fopen(path, "r");
+	if (!f)
+		return 1;
+
+	while (!ret && getline(&line, &len, f) != -1) {
+		line[strcspn(line, "\r\n")] = '\0';
+		if (line[0] == '\0' || line[0] == '#')
+			continue;
+
+		ret = batch_add(b, line, &cap);
+	}
+
+	free(line);
+	fclose(f);
+	return ret;
+}
+
+int batch(int argc, char **argv)
+{
+	static struct option opts[] = {
+		{ "solver",	required_argument,	NULL, 's' },
+		{ "threads",	required_argument,	NULL, 'j' },
+		{ "resolution",	required_argument,	NULL, 'r' },
+		{ "max-rounds",	required_argument,	NULL, 'x' },
+		{ "exact",	no_argument,		NULL, 'E' },
+		{ NULL,		0,			NULL, 0 }
+	};
+	struct timespec start;
+	struct batch b;
+	pthread_t *tid;
+	int nth = 1, opt, i;
+	double ms;
+
+	memset(&b, 0, sizeof(b));
+	b.solver = SOLVER_SWEEP;
+	b.rounds = XI;
+
+	while ((opt = getopt_long(argc, argv, "j:s:r:x:", opts, NULL)) != -1) {
+		switch (opt) {
+		case 'j':
+			nth = atoi(optarg);
+			if (nth == 0)
+				nth = sysconf(_SC_NPROCESSORS_ONLN);
+			if (nth < 1)
+				usage();
+			break;
+		case 'r':
+			if (tick_set_res(atoll(optarg)))
+				usage();
+			break;
+		case 'x':
+			b.rounds = atoi(optarg);
+			if (b.rounds < 0)
+				usage();
+			break;
+		case 'E':
+			b.exact = 1;
+			break;
+		case 's':
+			if (strcmp(optarg, "sweep") == 0)
+				b.solver = SOLVER_SWEEP;
+			else if (strcmp(optarg, "worklist") == 0)
+				b.solver = SOLVER_WORKLIST;
+			else
+				usage();
+			break;
+		default:
+			usage();
+		}
+	}
+
+	if (optind != argc - 1)
+		usage();
+
+	if (batch_list(&b, argv[optind]))
+		err_exit("ERROR reading model list %s\n", argv[optind]);
+
+	b.res = (struct batch_res *)calloc(b.nf + 1, sizeof(*b.res));
+	tid = (pthread_t *)malloc(nth * sizeof(pthread_t));
+	if (!b.res || !tid)
+		err_exit("ERROR allocating batch\n");
+	pthread_mutex_init(&b.lock, NULL);
+
+	printf("# file\tverdict\ttasks\tvertices\tutil\tmax.tard\tms\n");
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	/* one model per worker at a time, each analysed single-threaded */
+	for (i = 1; i < nth; i++) {
+		if (pthread_create(&tid[i], NULL, batch_worker, &b))
+			err_exit("ERROR creating batch thread\n");
+	}
+
+	batch_worker(&b);
+
+	for (i = 1; i < nth; i++)
+		pthread_join(tid[i], NULL);
+
+	ms = elapsed_ms(&start);
+
+	printf("# %d models (%d schedulable, %d not schedulable, %d errors)"
+		" in %.3f s, %.1f models/s\n", b.nf, b.cnt[VERDICT_SCHED],
+		b.cnt[VERDICT_UNSCHED], b.cnt[VERDICT_ERROR], ms / 1e3,
+		ms > 0 ? b.nf / (ms / 1e3) : 0.0);
+
+	pthread_mutex_destroy(&b.lock);
+	for (i = 0; i < b.nf; i++)
+		free(b.file[i]);
+	free(b.file);
+	free(b.res);
+	free(tid);
+
+	return b.cnt[VERDICT_ERROR] ? EXIT_FAILURE : 0;
+}
+
+/*
+ * Resident analysis server. Every request and response is one frame:
+ * a 4-byte length in network byte order followed by that many bytes of
+ * text. A request is one command line; a response starts with "ok" or
+ * "error <reason>", and results follow on further lines.
+ *
+ * One thread polls the listening socket and every connection, and
+ * queues each complete request for the pool of workers. A connection
+ * is not polled while its request is served, so that its responses go
+ * out in order.
+ */
+#define SERVE_FRAME_MAX	(1 << 20)
+#define SERVE_BACKLOG	16
+#define SERVE_TIMEOUT	10	/* s a client may stall a response	*/
+
+struct model {
+	char *name;
+	struct taskset ts;
+	int analysed;		/* ts holds the results of an analysis	*/
+	int sched;		/* and the verdict			*/
+	int refs;		/* the table and requests using it	*/
+	pthread_mutex_t lock;	/* one request on the model at a time	*/
+};
+
+struct conn {
+	int fd;
+	uint32_t len;		/* of the request being read		*/
+	size_t got;		/* bytes of it read, length included	*/
+	char *req;
+	int busy;		/* queued or being served		*/
+	int gone;		/* hung up or failed			*/
+	struct conn *next;	/* in the queue				*/
+};
+
+struct server {
+	int fd;			/* listening socket			*/
+	int wake[2];		/* workers wake the poll thread		*/
+	int solver;
+	int rounds;		/* --max-rounds and --exact		*/
+	int exact;
+	int stop;		/* a shutdown request was served	*/
+
+	struct model **m;	/* loaded models			*/
+	int nm, cap;
+	pthread_mutex_t lock;	/* protects m, nm and every refs	*/
+
+	struct conn **c;	/* clients, of the poll thread		*/
+	int nc, ccap;
+
+	struct conn *qhead;	/* requests waiting for a worker	*/
+	struct conn *qtail;
+	int quit;		/* workers exit once the queue is empty	*/
+	pthread_mutex_t qlock;	/* protects the queue, quit and every
+				   busy and gone			*/
+	pthread_cond_t qcond;
+};
+
+void model_put_locked(struct model *m)
+{
+	if (--m->refs)
+		return;
+
+	taskset_finalize(&m->ts);
+	pthread_mutex_destroy(&m->lock);
+	free(m->name);
+	free(m);
+}
+
+void model_put(struct server *s, struct model *m)
+{
+	pthread_mutex_lock(&s->lock);
+	model_put_locked(m);
+	pthread_mutex_unlock(&s->lock);
+}
+
+/* index of the model called name, -1 if none; s->lock held */
+int server_find(struct server *s, const char *name)
+{
+	int i;
+
+	for (i = 0; i < s->nm; i++) {
+		if (strcmp(s->m[i]->name, name) == 0)
+			return i;
+	}
+
+	return -1;
+}
+
+/* the model called name, held until model_put(), or NULL */
+struct model *server_get(struct server *s, const char *name)
+{
+	struct model *m = NULL;
+	int i;
+
+	pthread_mutex_lock(&s->lock);
+	i = server_find(s, name);
+	if (i >= 0) {
+		m = s->m[i];
+		m->refs++;
+	}
+	pthread_mutex_unlock(&s->lock);
+
+	return m;
+}
+
+int taskset_nv(struct taskset *ts)
+{
+	int i, nv = 0;
+
+	for (i = 0; i < ts->nt; i++)
+		nv += ts->t[i].nv;
+
+	return nv;
+}
+
+void serve_results(FILE *f, struct taskset *ts)
+{
+	int i, j;
+
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		fprintf(f, "task\t%d\t%.*f\t%.*f\t%.*f\n", t->id,
+			tick_prec, tick_unit(t->resp), tick_prec,
+			tick_unit(t->tard), tick_prec, tick_unit(t->d));
+		for (j = 0; j < t->nv; j++)
+			fprintf(f, "vertex\t%d\t%d\t%.*f\t%.*f\n", t->id,
+				t->v[j].id, tick_prec, tick_unit(t->v[j].resp),
+				tick_prec, tick_unit(t->v[j].tard));
+	}
+}
+
+int serve_load(struct server *s, FILE *f, const char *name,
+	       const char *file)
+{
+	struct model *m, **tmp;
+	int i, nt, nv;
+
+	m = (struct model *)calloc(1, sizeof(*m));
+	if (!m)
+		goto err;
+
+	m->name = strdup(name);
+	if (!m->name)
+		goto err;
+
+	if (taskset_load(&m->ts, file)) {
+		free(m->name);
+		free(m);
+		fprintf(f, "error cannot load %s\n", file);
+		return 0;
+	}
+
+	m->ts.nth = 1;
+	m->ts.solver = s->solver;
+	m->ts.rounds = s->rounds;
+	m->ts.exact = s->exact;
+	m->refs = 1;
+	pthread_mutex_init(&m->lock, NULL);
+
+	/* once in the table, another load may drop it */
+	nt = m->ts.nt;
+	nv = taskset_nv(&m->ts);
+
+	pthread_mutex_lock(&s->lock);
+	i = server_find(s, name);
+	if (i >= 0) {
+		model_put_locked(s->m[i]);
+		s->m[i] = m;
+	} else {
+		if (s->nm == s->cap) {
+			s->cap = s->cap ? 2 * s->cap : 16;
+			tmp = (struct model **)realloc(s->m,
+					s->cap * sizeof(*tmp));
+			if (!tmp) {
+				s->cap = s->nm;
+				model_put_locked(m);
+				pthread_mutex_unlock(&s->lock);
+				return 1;
+			}
+			s->m = tmp;
+		}
+		s->m[s->nm++] = m;
+	}
+	pthread_mutex_unlock(&s->lock);
+
+	fprintf(f, "ok %d %d\n", nt, nv);
+	return 0;
+err:
+	if (m)
+		free(m->name);
+	free(m);
+	return 1;
+}
+
+int serve_unload(struct server *s, FILE *f, const char *name)
+{
+	int i;
+
+	pthread_mutex_lock(&s->lock);
+	i = server_find(s, name);
+	if (i >= 0) {
+		model_put_locked(s->m[i]);
+		s->m[i] = s->m[--s->nm];
+	}
+	pthread_mutex_unlock(&s->lock);
+
+	if (i < 0)
+		fprintf(f, "error no model %s\n", name);
+	else
+		fprintf(f, "ok\n");
+	return 0;
+}
+
+void serve_list(struct server *s, FILE *f)
+{
+	int i;
+
+	pthread_mutex_lock(&s->lock);
+	fprintf(f, "ok %d\n", s->nm);
+	for (i = 0; i < s->nm; i++)
+		fprintf(f, "%s\t%d\t%d\n", s->m[i]->name, s->m[i]->ts.nt,
+			taskset_nv(&s->m[i]->ts));
+	pthread_mutex_unlock(&s->lock);
+}
+
+/* analyse, patch and results: the requests on one loaded model */
+int serve_model(struct server *s, FILE *f, const char *cmd,
+		const char *name, const char *arg)
+{
+	static const char *verdict[] = { "unschedulable", "schedulable" };
+	struct timespec start;
+	struct whatif w;
+	struct model *m;
+
+	m = server_get(s, name);
+	if (!m) {
+		fprintf(f, "error no model %s\n", name);
+		return 0;
+	}
+
+	pthread_mutex_lock(&m->lock);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	if (strcmp(cmd, "analyse") == 0) {
+		if (rta(&m->ts, &m->sched)) {
+			fprintf(f, "error analysis failed\n");
+			goto out;
+		}
+		m->analysed = 1;
+	} else if (strcmp(cmd, "patch") == 0) {
+		if (!arg || whatif_parse(&m->ts, arg, &w)) {
+			fprintf(f, "error bad patch %s\n", arg ? arg : "");
+			goto out;
+		}
+		if (rta_whatif(&m->ts, &w, &m->sched)) {
+			m->analysed = 0;
+			fprintf(f, "error analysis failed\n");
+			goto out;
+		}
+		m->analysed = 1;
+	} else if (!m->analysed) {
+		fprintf(f, "error %s not analysed\n", name);
+		goto out;
+	}
+
+	fprintf(f, "ok %s %.3f\n", verdict[m->sched], elapsed_ms(&start));
+	serve_results(f, &m->ts);
+out:
+	pthread_mutex_unlock(&m->lock);
+	model_put(s, m);
+	return 0;
+}
+
+/* run one request, writing the response to f */
+int serve_request(struct server *s, FILE *f, char *req)
+{
+	char *cmd, *name, *arg, *save;
+
+	cmd = strtok_r(req, " \t\r\n", &save);
+	name = strtok_r(NULL, " \t\r\n", &save);
+	arg = strtok_r(NULL, "\r\n", &save);
+	if (arg)
+		arg += strspn(arg, " \t");
+
+	if (!cmd) {
+		fprintf(f, "error empty request\n");
+		return 0;
+	}
+
+	if (strcmp(cmd, "list") == 0) {
+		serve_list(s, f);
+		return 0;
+	}
+
+	if (strcmp(cmd, "shutdown") == 0) {
+		__atomic_store_n(&s->stop, 1, __ATOMIC_RELEASE);
+		fprintf(f, "ok\n");
+		return 0;
+	}
+
+	if (strcmp(cmd, "load") && strcmp(cmd, "unload") &&
+	    strcmp(cmd, "analyse") && strcmp(cmd, "patch") &&
+	    strcmp(cmd, "results")) {
+		fprintf(f, "error unknown request %s\n", cmd);
+		return 0;
+	}
+
+	if (!name) {
+		fprintf(f, "error %s needs a model name\n", cmd);
+		return 0;
+	}
+
+	if (strcmp(cmd, "load") == 0) {
+		if (!arg || !*arg) {
+			fprintf(f, "error load needs a file\n");
+			return 0;
+		}
+		return serve_load(s, f, name, arg);
+	}
+
+	if (strcmp(cmd, "unload") == 0)
+		return serve_unload(s, f, name);
+
+	return serve_model(s, f, cmd, name, arg);
+}
+
+int write_full(int fd, const void *buf, size_t len)
+{
+	const char *p = buf;
+	ssize_t n;
+
+	while (len) {
+		n = send(fd, p, len, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0)
+			return 1;
+		p += n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+void serve_wake(struct server *s)
+{
+	char c = 0;
+
+	/* a full pipe wakes the poll thread as well */
+	if (write(s->wake[1], &c, 1) < 0)
+		return;
+}
+
+/* read what arrived of the next request; 1 if the client is gone */
+int conn_read(struct conn *c)
+{
+	ssize_t n;
+
+	if (c->got < sizeof(c->len)) {
+		n = read(c->fd, (char *)&c->len + c->got,
+			 sizeof(c->len) - c->got);
+	} else {
+		n = read(c->fd, c->req + c->got - sizeof(c->len),
+			 c->len + sizeof(c->len) - c->got);
+	}
+	if (n < 0 && errno == EINTR)
+		return 0;
+	if (n <= 0)
+		return 1;
+
+	c->got += n;
+	if (c->got == sizeof(c->len)) {
+		c->len = ntohl(c->len);
+		if (c->len > SERVE_FRAME_MAX)
+			return 1;
+
+		free(c->req);
+		c->req = (char *)malloc(c->len + 1);
+		if (!c->req)
+			return 1;
+	}
+
+	return 0;
+}
+
+/* hand the request of c to the workers once it is complete */
+void conn_queue(struct server *s, struct conn *c)
+{
+	if (c->got < sizeof(c->len) || c->got < sizeof(c->len) + c->len)
+		return;
+
+	c->req[c->len] = '\0';
+	c->got = 0;
+
+	pthread_mutex_lock(&s->qlock);
+	c->busy = 1;
+	c->next = NULL;
+	if (s->qtail)
+		s->qtail->next = c;
+	else
+		s->qhead = c;
+	s->qtail = c;
+	pthread_cond_signal(&s->qcond);
+	pthread_mutex_unlock(&s->qlock);
+}
+
+void conn_free(struct conn *c)
+{
+	close(c->fd);
+	free(c->req);
+	free(c);
+}
+
+void *serve_worker(void *arg)
+{
+	struct server *s = arg;
+	struct conn *c;
+	char *resp;
+	size_t rlen;
+	uint32_t len;
+	FILE *f;
+	int err;
+
+	for (;;) {
+		pthread_mutex_lock(&s->qlock);
+		while (!s->qhead && !s->quit)
+			pthread_cond_wait(&s->qcond, &s->qlock);
+		c = s->qhead;
+		if (c) {
+			s->qhead = c->next;
+			if (!s->qhead)
+				s->qtail = NULL;
+		}
+		pthread_mutex_unlock(&s->qlock);
+
+		if (!c)
+			break;
+
+		err = 1;
+		f = open_memstream(&resp, &rlen);
+		if (f) {
+			if (serve_request(s, f, c->req))
+				fprintf(f, "error out of memory\n");
+			fclose(f);
+
+			len = htonl(rlen);
+			err = write_full(c->fd, &len, sizeof(len)) ||
+			      write_full(c->fd, resp, rlen);
+			free(resp);
+		}
+
+		pthread_mutex_lock(&s->qlock);
+		c->busy = 0;
+		c->gone |= err;
+		pthread_mutex_unlock(&s->qlock);
+		serve_wake(s);
+	}
+
+	return NULL;
+}
+
+/*
+ * Accept clients and read their requests until a shutdown request was
+ * served, then hang up on every client once its request is answered.
+ */
+int serve_poll(struct server *s)
+{
+	struct timeval tv = { SERVE_TIMEOUT, 0 };
+	struct pollfd *pfd = NULL, *tmp;
+	struct conn **ctmp, *c;
+	int np = 0, stop, i, fd, ret = 1;
+	char buf[64];
+
+	for (;;) {
+		stop = __atomic_load_n(&s->stop, __ATOMIC_ACQUIRE);
+
+		pthread_mutex_lock(&s->qlock);
+		for (i = 0; i < s->nc;) {
+			if (!s->c[i]->busy && (s->c[i]->gone || stop)) {
+				conn_free(s->c[i]);
+				s->c[i] = s->c[--s->nc];
+			} else {
+				i++;
+			}
+		}
+		pthread_mutex_unlock(&s->qlock);
+
+		if (stop && !s->nc)
+			break;
+
+		/* room for one more client */
+		if (s->nc == s->ccap) {
+			s->ccap = s->ccap ? 2 * s->ccap : 16;
+			ctmp = (struct conn **)realloc(s->c, s->ccap *
+						       sizeof(*ctmp));
+			if (!ctmp)
+				goto out;
+			s->c = ctmp;
+		}
+		if (np < 2 + s->ccap) {
+			np = 2 + s->ccap;
+			tmp = (struct pollfd *)realloc(pfd, np * sizeof(*tmp));
+			if (!tmp)
+				goto out;
+			pfd = tmp;
+		}
+
+		/* the wake pipe, the listening socket and idle clients */
+		pfd[0].fd = s->wake[0];
+		pfd[1].fd = stop ? -1 : s->fd;
+		pthread_mutex_lock(&s->qlock);
+		for (i = 0; i < s->nc; i++)
+			pfd[2 + i].fd = s->c[i]->busy ? -1 : s->c[i]->fd;
+		pthread_mutex_unlock(&s->qlock);
+		for (i = 0; i < 2 + s->nc; i++) {
+			pfd[i].events = POLLIN;
+			pfd[i].revents = 0;
+		}
+
+		if (poll(pfd, 2 + s->nc, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			goto out;
+		}
+
+		if (pfd[0].revents) {
+			while (read(s->wake[0], buf, sizeof(buf)) > 0)
+				;
+		}
+
+		/* polled clients are idle, and stay so until queued */
+		for (i = 0; i < s->nc; i++) {
+			c = s->c[i];
+			if (!pfd[2 + i].revents)
+				continue;
+
+			if (conn_read(c)) {
+				pthread_mutex_lock(&s->qlock);
+				c->gone = 1;
+				pthread_mutex_unlock(&s->qlock);
+			} else {
+				conn_queue(s, c);
+			}
+		}
+
+		if (pfd[1].revents) {
+			fd = accept(s->fd, NULL, NULL);
+			if (fd < 0) {
+				if (errno == EINTR || errno == EAGAIN ||
+				    errno == ECONNABORTED)
+					continue;
+				goto out;
+			}
+
+			/* clients that don't read responses are dropped */
+			c = (struct conn *)calloc(1, sizeof(*c));
+			if (!c || setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv,
+					     sizeof(tv))) {
+				free(c);
+				close(fd);
+				continue;
+			}
+			c->fd = fd;
+			s->c[s->nc++] = c;
+		}
+	}
+
+	ret = 0;
+out:
+	pthread_mutex_lock(&s->qlock);
+	s->quit = 1;
+	pthread_cond_broadcast(&s->qcond);
+	pthread_mutex_unlock(&s->qlock);
+
+	free(pfd);
+	return ret;
+}
+
+int serve(int argc, char **argv)
+{
+	static struct option opts[] = {
+		{ "solver",	required_argument,	NULL, 's' },
+		{ "threads",	required_argument,	NULL, 'j' },
+		{ "resolution",	required_argument,	NULL, 'r' },
+		{ "max-rounds",	required_argument,	NULL, 'x' },
+		{ "exact",	no_argument,		NULL, 'E' },
+		{ NULL,		0,			NULL, 0 }
+	};
+	struct sockaddr_un addr;
+	struct server s;
+	struct stat st;
+	pthread_t *tid;
+	int nth = 0, opt, ret, i;
+
+	memset(&s, 0, sizeof(s));
+	s.solver = SOLVER_SWEEP;
+	s.rounds = XI;
+
+	while ((opt = getopt_long(argc, argv, "j:s:r:x:", opts, NULL)) != -1) {
+		switch (opt) {
+		case 'j':
+			nth = atoi(optarg);
+			if (nth < 0)
+				usage();
+			break;
+		case 'r':
+			if (tick_set_res(atoll(optarg)))
+				usage();
+			break;
+		case 'x':
+			s.rounds = atoi(optarg);
+			if (s.rounds < 0)
+				usage();
+			break;
+		case 'E':
+			s.exact = 1;
+			break;
+		case 's':
+			if (strcmp(optarg, "sweep") == 0)
+				s.solver = SOLVER_SWEEP;
+			else if (strcmp(optarg, "worklist") == 0)
+				s.solver = SOLVER_WORKLIST;
+			else
+				usage();
+			break;
+		default:
+			usage();
+		}
+	}
+
+	if (optind != argc - 1)
+		usage();
+
+	if (nth == 0)
+		nth = max(sysconf(_SC_NPROCESSORS_ONLN), 1);
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (strlen(argv[optind]) >= sizeof(addr.sun_path))
+		err_exit("ERROR socket path too long: %s\n", argv[optind]);
+	strcpy(addr.sun_path, argv[optind]);
+
+	s.fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (s.fd < 0)
+		err_exit("ERROR creating socket\n");
+
+	/* a stale socket is replaced, anything else at the path is kept */
+	if (lstat(addr.sun_path, &st) == 0) {
+		if (!S_ISSOCK(st.st_mode))
+			err_exit("ERROR %s exists and is not a socket\n",
+				 addr.sun_path);
+		unlink(addr.sun_path);
+	}
+	if (bind(s.fd, (struct sockaddr *)&addr, sizeof(addr)) ||
+	    listen(s.fd, SERVE_BACKLOG))
+		err_exit("ERROR listening on %s\n", addr.sun_path);
+
+	if (pipe(s.wake) ||
+	    fcntl(s.fd, F_SETFL, O_NONBLOCK) ||
+	    fcntl(s.wake[0], F_SETFL, O_NONBLOCK) ||
+	    fcntl(s.wake[1], F_SETFL, O_NONBLOCK))
+		err_exit("ERROR creating server\n");
+
+	tid = (pthread_t *)malloc(nth * sizeof(pthread_t));
+	if (!tid)
+		err_exit("ERROR allocating server\n");
+	pthread_mutex_init(&s.lock, NULL);
+	pthread_mutex_init(&s.qlock, NULL);
+	pthread_cond_init(&s.qcond, NULL);
+
+	/* workers serve requests, of any client, as they come */
+	for (i = 0; i < nth; i++) {
+		if (pthread_create(&tid[i], NULL, serve_worker, &s))
+			err_exit("ERROR creating server thread\n");
+	}
+
+	ret = serve_poll(&s);
+
+	for (i = 0; i < nth; i++)
+		pthread_join(tid[i], NULL);
+
+	close(s.fd);
+	close(s.wake[0]);
+	close(s.wake[1]);
+	unlink(addr.sun_path);
+
+	for (i = 0; i < s.nc; i++)
+		conn_free(s.c[i]);
+	for (i = 0; i < s.nm; i++)
+		model_put_locked(s.m[i]);
+	pthread_cond_destroy(&s.qcond);
+	pthread_mutex_destroy(&s.qlock);
+	pthread_mutex_destroy(&s.lock);
+	free(s.c);
+	free(s.m);
+	free(tid);
+
+	return ret ? EXIT_FAILURE : 0;
+}
+
+#define EXIT_UNSCHED	2	/* --verdict-only: not schedulable	*/
+
+/* the verdict and the test that settled it, for --verdict-only */
+void verdict_print(struct taskset *ts, int sched)
+{
+	struct task *t = ts->byt;
+
+	printf("%s: ", sched ? "schedulable" : "NOT schedulable");
+
+	switch (ts->by) {
+	case BY_BOUND:
+		printf("RTA, from lower bounds\n");
+		break;
+	case BY_LENGTH:
+		printf("critical path of %s is %.*f > deadline %.*f\n",
+			t->name, tick_prec, tick_unit(t->len), tick_prec,
+			tick_unit(t->d));
+		break;
+	case BY_LOAD:
+		printf("%s loads %s with %.2f > %d CPUs\n", t->name,
+			ts->byn->name, (double)ts->byn->load / t->p,
+			ts->byn->cpus);
+		break;
+	default:
+		printf("RTA\n");
+	}
+}
+
+void fixed_print(struct taskset *ts)
+{
+	if (!ts->fixed)
+		printf("Not a fixed point after %d rounds: more rounds may"
+			" change the bounds.\n", ts->nr);
+}
+
+void warm_print(const char *file, int wres)
+{
+	static const char *why[] = {
+		"started from its bounds",
+		"unreadable or not a bounds file",
+		"another model or resolution",
+		"some WCET grew",
+		"no fixed point from its bounds, started from the deadlines"
+	};
+
+	if (wres != WARM_OK && wres != WARM_COLD)
+		printf("Warm start %s: %s, started from the deadlines.\n",
+			file, why[wres]);
+	else
+		printf("Warm start %s: %s.\n", file, why[wres]);
+}
+
+/*
+ * Results in one of FORMAT_*, at one of OUT_* levels of detail, and
+ * with the vertices limited to the top ones by tardiness if asked.
+ * Output goes through a stdio buffer of OUT_BUF bytes; the JSON and
+ * CSV rows are assembled without printf.
+ */
+#define FORMAT_TEXT	0
+#define FORMAT_JSON	1	/* one object per analysis and line	*/
+#define FORMAT_CSV	2
+
+#define OUT_ALL		0	/* tasks and vertices			*/
+#define OUT_SUMMARY	1	/* tasks only				*/
+#define OUT_VERDICT	2	/* the verdict only (--quiet)		*/
+
+#define OUT_BUF		(1 << 20)
+
+struct out {
+	FILE *f;
+	int format;		/* FORMAT_*				*/
+	int detail;		/* OUT_*				*/
+	int top;		/* vertices with the largest tardiness	*/
+	int head;		/* the CSV header is out		*/
+};
+
+void out_str(struct out *o, const char *s)
+{
+	fputs(s, o->f);
+}
+
+void out_json_str(struct out *o, const char *s)
+{
+	static const char hex[] = "0123456789abcdef";
+
+	putc('"', o->f);
+	for (; *s; s++) {
+		unsigned char c = *s;
+
+		if (c == '"' || c == '\\') {
+			putc('\\', o->f);
+			putc(c, o->f);
+		} else if (c < 0x20) {
+			fputs("\\u00", o->f);
+			putc(hex[c >> 4], o->f);
+			putc(hex[c & 15], o->f);
+		} else {
+			putc(c, o->f);
+		}
+	}
+	putc('"', o->f);
+}
+
+void out_csv_str(struct out *o, const char *s)
+{
+	if (!s[strcspn(s, ",\"\r\n")]) {
+		fputs(s, o->f);
+		return;
+	}
+
+	putc('"', o->f);
+	for (; *s; s++) {
+		if (*s == '"')
+			putc('"', o->f);
+		putc(*s, o->f);
+	}
+	putc('"', o->f);
+}
+
+void out_int(struct out *o, int64_t n)
+{
+	char buf[24], *p = buf + sizeof(buf);
+	uint64_t u = n < 0 ? -(uint64_t)n : (uint64_t)n;
+
+	*--p = '\0';
+	do {
+		*--p = '0' + u % 10;
+		u /= 10;
+	} while (u);
+
+	if (n < 0)
+		*--p = '-';
+
+	fputs(p, o->f);
+}
+
+void out_tick(struct out *o, tick_t t)
+{
+	char buf[32];
+
+	fputs(tick_str(t, buf), o->f);
+}
+
+int vert_cmp_tard(const void *a, const void *b)
+{
+	const struct vert *u = *(struct vert * const *)a;
+	const struct vert *v = *(struct vert * const *)b;
+
+	if (u->tard != v->tard)
+		return u->tard > v->tard ? -1 : 1;
+	if (u->t->id != v->t->id)
+		return u->t->id - v->t->id;
+
+	return u->id - v->id;
+}
+
+/*
+ * The k vertices of ts with the largest tardiness, in decreasing order:
+ * a heap of the k best so far, whose root is the least of them.
+ */
+int top_verts(struct taskset *ts, int k, struct vert ***top, int *ntop)
+{
+	struct vert **h;
+	int i, j, n = 0;
+
+	k = min(k, ts->nv);
+	h = (struct vert **)malloc(max(k, 1) * sizeof(struct vert *));
+	if (!h)
+		return 1;
+
+	for (i = 0; i < ts->nt; i++) {
+		for (j = 0; j < ts->t[i].nv; j++) {
+			struct vert *v = &ts->t[i].v[j];
+			int c, p;
+
+			if (n < k) {
+				/* sift up */
+				for (c = n++; c > 0; c = p) {
+					p = (c - 1) / 2;
+					if (vert_cmp_tard(&h[p], &v) >= 0)
+						break;
+					h[c] = h[p];
+				}
+				h[c] = v;
+				continue;
+			}
+
+			if (vert_cmp_tard(&v, &h[0]) >= 0)
+				continue;
+
+			/* replace the root and sift down */
+			for (p = 0; (c = 2 * p + 1) < n; p = c) {
+				if (c + 1 < n && vert_cmp_tard(&h[c + 1],
+							       &h[c]) > 0)
+					c++;
+				if (vert_cmp_tard(&v, &h[c]) >= 0)
+					break;
+				h[p] = h[c];
+			}
+			h[p] = v;
+		}
+	}
+
+	sort(h, n, sizeof(struct vert *), vert_cmp_tard);
+	*top = h;
+	*ntop = n;
+	return 0;
+}
+
+void out_text(struct out *o, struct taskset *ts, struct vert **top,
+	      int ntop)
+{
+	int i;
+
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+		char id[16], resp[32], tard[32], d[32];
+
+		snprintf(id, sizeof(id), "TASK %d", t->id);
+		fprintf(o->f, "\n%10s:  resp.time = %s,  tardiness = %s"
+			" (D = %s)\n", id, tick_str(t->resp, resp),
+			tick_str(t->tard, tard), tick_str(t->d, d));
+	}
+
+	if (!top)
+		return;
+
+	fprintf(o->f, "\nWorst %d vertices by tardiness:\n\n", ntop);
+	fprintf(o->f, "        task        vertex     resp.time     tardiness"
+		"     dead.miss\n");
+	for (i = 0; i < ntop; i++) {
+		struct vert *v = top[i];
+		char resp[32], tard[32];
+
+		fprintf(o->f, "%12d%14d%14s%14s%s\n", v->t->id, v->id,
+			tick_str(v->resp, resp), tick_str(v->tard, tard),
+			v->tard > 0 ? "         X" : "");
+	}
+}
+
+void out_json_vert(struct out *o, struct vert *v, int first)
+{
+	out_str(o, first ? "{\"task\": " : ", {\"task\": ");
+	out_int(o, v->t->id);
+	out_str(o, ", \"id\": ");
+	out_int(o, v->id);
+	out_str(o, ", \"name\": ");
+	out_json_str(o, v->name);
+	out_str(o, ", \"node\": ");
+	out_json_str(o, v->n->name);
+	out_str(o, ", \"response\": ");
+	out_tick(o, v->resp);
+	out_str(o, ", \"tardiness\": ");
+	out_tick(o, v->tard);
+	out_str(o, "}");
+}
+
+void out_json(struct out *o, struct taskset *ts, const char *whatif,
+	      int sched, struct vert **top, int ntop)
+{
+	int i, j;
+
+	out_str(o, "{\"analysis\": ");
+	if (whatif) {
+		out_str(o, "\"what-if\", \"what_if\": ");
+		out_json_str(o, whatif);
+	} else {
+		out_str(o, "\"rta\"");
+	}
+	out_str(o, sched ? ", \"schedulable\": true" :
+		", \"schedulable\": false");
+	out_str(o, ts->fixed ? ", \"fixed_point\": true" :
+		", \"fixed_point\": false");
+	out_str(o, ", \"rounds\": ");
+	out_int(o, ts->nr);
+
+	if (o->detail == OUT_VERDICT) {
+		out_str(o, "}\n");
+		return;
+	}
+
+	out_str(o, ", \"tasks\": [");
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		out_str(o, i ? ", {\"id\": " : "{\"id\": ");
+		out_int(o, t->id);
+		out_str(o, ", \"name\": ");
+		out_json_str(o, t->name);
+		out_str(o, ", \"deadline\": ");
+		out_tick(o, t->d);
+		out_str(o, ", \"period\": ");
+		out_tick(o, t->p);
+		out_str(o, ", \"response\": ");
+		out_tick(o, t->resp);
+		out_str(o, ", \"tardiness\": ");
+		out_tick(o, t->tard);
+		out_str(o, "}");
+	}
+	out_str(o, "]");
+
+	if (o->detail == OUT_ALL) {
+		out_str(o, ", \"vertices\": [");
+		if (top) {
+			for (i = 0; i < ntop; i++)
+				out_json_vert(o, top[i], !i);
+		} else {
+			for (i = 0; i < ts->nt; i++)
+				for (j = 0; j < ts->t[i].nv; j++)
+					out_json_vert(o, &ts->t[i].v[j],
+						      !i && !j);
+		}
+		out_str(o, "]");
+	}
+	out_str(o, "}\n");
+}
+
+/* analysis,record,task,vertex,name,node,response,tardiness,deadline,... */
+void out_csv_row(struct out *o, const char *whatif, const char *record,
+		 int task, int vert, const char *name, const char *node,
+		 tick_t resp, tick_t tard, const char *rest)
+{
+	out_csv_str(o, whatif ? whatif : "rta");
+	putc(',', o->f);
+	out_str(o, record);
+	putc(',', o->f);
+	if (task >= 0)
+		out_int(o, task);
+	putc(',', o->f);
+	if (vert >= 0)
+		out_int(o, vert);
+	putc(',', o->f);
+	out_csv_str(o, name);
+	putc(',', o->f);
+	out_csv_str(o, node);
+	putc(',', o->f);
+	out_tick(o, resp);
+	putc(',', o->f);
+	out_tick(o, tard);
+	putc(',', o->f);
+	out_str(o, rest);
+	putc('\n', o->f);
+}
+
+void out_csv_vert(struct out *o, const char *whatif, struct vert *v)
+{
+	out_csv_row(o, whatif, "vertex", v->t->id, v->id, v->name,
+		    v->n->name, v->resp, v->tard, v->tard > 0 ? ",miss," :
+		    ",ok,");
+}
+
+void out_csv(struct out *o, struct taskset *ts, const char *whatif,
+	     int sched, struct vert **top, int ntop)
+{
+	tick_t resp = 0, tard = 0;
+	char d[32], rest[64];
+	int i, j;
+
+	if (!o->head) {
+		out_str(o, "analysis,record,task,vertex,name,node,response,"
+			"tardiness,deadline,status,fixed_point\n");
+		o->head = 1;
+	}
+
+	for (i = 0; i < ts->nt; i++) {
+		if (!i || ts->t[i].tard > tard) {
+			resp = ts->t[i].resp;
+			tard = ts->t[i].tard;
+		}
+	}
+
+	snprintf(rest, sizeof(rest), ",%s,%d", sched ? "schedulable" :
+		 "unschedulable", ts->fixed);
+	out_csv_row(o, whatif, "taskset", -1, -1, "", "", resp, tard, rest);
+
+	if (o->detail == OUT_VERDICT)
+		return;
+
+	for (i = 0; i < ts->nt; i++) {
+		struct task *t = &ts->t[i];
+
+		snprintf(rest, sizeof(rest), "%s,%s,", tick_str(t->d, d),
+			 t->tard > 0 ? "miss" : "ok");
+		out_csv_row(o, whatif, "task", t->id, -1, t->name, "",
+			    t->resp, t->tard, rest);
+	}
+
+	if (o->detail != OUT_ALL)
+		return;
+
+	if (top) {
+		for (i = 0; i < ntop; i++)
+			out_csv_vert(o, whatif, top[i]);
+		return;
+	}
+
+	for (i = 0; i < ts->nt; i++)
+		for (j = 0; j < ts->t[i].nv; j++)
+			out_csv_vert(o, whatif, &ts->t[i].v[j]);
+}
+
+/* the results of the last analysis of ts; whatif is its edit, if any */
+int out_results(struct out *o, struct taskset *ts, const char *whatif,
+		int sched)
+{
+	struct vert **top = NULL;
+	int ntop = 0;
+
+	if (o->top && o->detail == OUT_ALL &&
+	    top_verts(ts, o->top, &top, &ntop))
+		return 1;
+
+	switch (o->format) {
+	case FORMAT_JSON:
+		out_json(o, ts, whatif, sched, top, ntop);
+		break;
+	case FORMAT_CSV:
+		out_csv(o, ts, whatif, sched, top, ntop);
+		break;
+	default:
+		if (whatif)
+			fprintf(o->f, "\nWhat-if %s: the taskset is %s"
+				" according to RTA:\n", whatif,
+				sched ? "schedulable" : "NOT schedulable");
+		else if (sched)
+			fprintf(o->f, "\nThe taskset is schedulable"
+				" according to RTA:\n");
+		else
+			fprintf(o->f, "\nThe taskset is NOT schedulable"
+				" according to RTA.\n");
+
+		if (o->detail == OUT_ALL && !top)
+			taskset_stat(ts);
+		else if (o->detail != OUT_VERDICT)
+			out_text(o, ts, top, ntop);
+		fixed_print(ts);
+	}
+
+	free(top);
+	return 0;
+}
+
+#define STATS_NONE	0
+#define STATS_TABLE	1
+#define STATS_JSON	2
+struct run_stats {
+	struct phase load;	/* taskset_load(), of which:		*/
+	struct phase parse;	/*   reading the model			*/
+	struct phase closure;	/*   reachability closures		*/
+	struct phase length;	/*   volumes and critical paths		*/
+	struct phase assign;	/* priority assignment			*/
+	struct phase map;	/* mapping exploration			*/
+	struct phase rta;	/* schedulability test, of which:	*/
+	struct phase prepare;	/*   interferer tables			*/
+	struct phase iter;	/*   fixed-point iterations		*/
+	struct phase slack;	/* WCET slack table			*/
+	struct phase mc;	/* Monte Carlo samples			*/
+	struct phase whatif;	/* what-if analyses			*/
+	struct phase output;	/* printing the results			*/
+	struct phase total;
+
+	int nu;			/* outer rounds of the test		*/
+	int capped;		/* the test stopped at XI		*/
+	int fixed;		/* and ended at X = Y			*/
+};
+
+/* peak resident set size in kB, -1 if unknown */
+long peak_rss(void)
+{
+	char line[128];
+	long kb = -1;
+	FILE *f;
+
+	f = fopen("/proc/self/status", "r");
+	if (!f)
+		return -1;
+
+	while (fgets(line, sizeof(line), f)) {
+		if (sscanf(line, "VmHWM: %ld kB", &kb) == 1)
+			break;
+	}
+
+	fclose(f);
+	return kb;
+}
+
+/* heap in use, in kB; -1 if unknown */
+long heap_kb(void)
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+	struct mallinfo2 mi = mallinfo2();
+
+	return (mi.uordblks + mi.hblkhd) / 1024;
+#else
+	return -1;
+#endif
+}
+
+void stats_print(FILE *f, struct taskset *ts, struct run_stats *rs, int fmt)
+{
+	static const char *name[] = {
+		"load", "  parse", "  closure", "  lengths", "assign",
+		"mapping", "analysis", "  prepare", "  iterations", "slack",
+		"monte carlo", "what-if", "output", "total"
+	};
+	static const char *key[] = {
+		"load", "parse", "closure", "lengths", "assign",
+		"mapping", "analysis", "prepare", "iterations", "slack",
+		"monte_carlo", "what_if", "output", "total"
+	};
+	struct phase *p[] = {
+		&rs->load, &rs->parse, &rs->closure, &rs->length, &rs->assign,
+		&rs->map, &rs->rta, &rs->prepare, &rs->iter, &rs->slack,
+		&rs->mc, &rs->whatif, &rs->output, &rs->total
+	};
+	uint64_t nreach = 0;
+	long rss = peak_rss(), heap = heap_kb();
+	int i, np = sizeof(p) / sizeof(p[0]);
+
+	for (i = 0; i < ts->nt; i++)
+		nreach += ts->t[i].nreach;
+
+	if (fmt == STATS_JSON) {
+		fprintf(f, "{\"phases\": {");
+		for (i = 0; i < np; i++)
+			fprintf(f, "%s\"%s\": {\"wall_ms\": %.3f,"
+				" \"cpu_ms\": %.3f}", i ? ", " : "", key[i],
+				p[i]->wall * 1e3, p[i]->cpu * 1e3);
+		fprintf(f, "}, \"analyses\": %" PRIu64 ", \"rounds\": %d,"
+			" \"rounds_total\": %" PRIu64 ", \"xi\": %d,"
+			" \"capped\": %s, \"capped_total\": %" PRIu64 ","
+			" \"fixed_point\": %s,"
+			" \"inner_iterations\": %" PRIu64 ","
+			" \"interference_terms\": %" PRIu64 ","
+			" \"reachability_queries\": %" PRIu64 ",",
+			ts->st.nrta, rs->nu, ts->st.nrounds, ts->rounds,
+			rs->capped ? "true" : "false", ts->st.ncapped,
+			rs->fixed ? "true" : "false",
+			ts->st.ninner, ts->st.nterm, nreach);
+		if (rss < 0)
+			fprintf(f, " \"peak_rss_kb\": null,");
+		else
+			fprintf(f, " \"peak_rss_kb\": %ld,", rss);
+		if (heap < 0)
+			fprintf(f, " \"heap_in_use_kb\": null}\n");
+		else
+			fprintf(f, " \"heap_in_use_kb\": %ld}\n", heap);
+		return;
+	}
+
+	fprintf(f, "\nStatistics:\n");
+	fprintf(f, "\t%-16s%12s%12s\n", "phase", "wall ms", "cpu ms");
+	for (i = 0; i < np; i++)
+		fprintf(f, "\t%-16s%12.3f%12.3f\n", name[i], p[i]->wall * 1e3,
+			p[i]->cpu * 1e3);
+
+	fprintf(f, "\n\t%-28s%" PRIu64 "\n", "analyses", ts->st.nrta);
+	fprintf(f, "\t%-28s%d (all analyses: %" PRIu64 ", XI %d)\n",
+		"outer rounds", rs->nu, ts->st.nrounds, ts->rounds);
+	fprintf(f, "\t%-28s%s (all analyses: %" PRIu64 ")\n", "capped by XI",
+		rs->capped ? "yes" : "no", ts->st.ncapped);
+	fprintf(f, "\t%-28s%s\n", "fixed point", rs->fixed ? "yes" : "no");
+	fprintf(f, "\t%-28s%" PRIu64 "\n", "inner iterations", ts->st.ninner);
+	fprintf(f, "\t%-28s%" PRIu64 "\n", "interference terms", ts->st.nterm);
+	fprintf(f, "\t%-28s%" PRIu64 "\n", "reachability queries", nreach);
+	if (rss < 0)
+		fprintf(f, "\t%-28s%s\n", "peak RSS", "n/a");
+	else
+		fprintf(f, "\t%-28s%ld kB\n", "peak RSS", rss);
+	if (heap < 0)
+		fprintf(f, "\t%-28s%s\n", "heap in use", "n/a");
+	else
+		fprintf(f, "\t%-28s%ld kB\n", "heap in use", heap);
+}
+
+int main(int argc, char **argv)
+{
+	static struct option opts[] = {
+		{ "solver",	required_argument,	NULL, 's' },
+		{ "threads",	required_argument,	NULL, 'j' },
+		{ "resolution",	required_argument,	NULL, 'r' },
+		{ "what-if",	required_argument,	NULL, 'w' },
+		{ "assign",	no_argument,		NULL, 'a' },
+		{ "output",	required_argument,	NULL, 'o' },
+		{ "slack",	no_argument,		NULL, 'S' },
+		{ "stats",	optional_argument,	NULL, 'T' },
+		{ "verdict-only", no_argument,		NULL, 'V' },
+		{ "monte-carlo", required_argument,	NULL, 'M' },
+		{ "seed",	required_argument,	NULL, 'R' },
+		{ "max-rounds",	required_argument,	NULL, 'x' },
+		{ "exact",	no_argument,		NULL, 'E' },
+		{ "save-bounds", required_argument,	NULL, 'B' },
+		{ "warm",	required_argument,	NULL, 'W' },
+		{ "format",	required_argument,	NULL, 'F' },
+		{ "quiet",	no_argument,		NULL, 'q' },
+		{ "summary",	no_argument,		NULL, 'U' },
+		{ "top",	required_argument,	NULL, 'K' },
+		{ "map",	required_argument,	NULL, 'm' },
+		{ NULL,		0,			NULL, 0 }
+	};
+	struct phase_clock c, total;
+	struct run_stats rs;
+	struct rta_stats st;
+	struct taskset ts;
+	struct out o;
+	char **wspec, *out = NULL, *save = NULL, *warm = NULL;
+	int sched, nth = 1, solver = SOLVER_SWEEP, nw = 0, assign = 0, opt, i;
+	int slack = 0, stats = STATS_NONE, verdict = 0, wres = WARM_OK;
+	int map = -1, rounds = XI, exact = 0, seeded = 0;
+	uint64_t seed = 1;
+	long mc = 0;
+
+	/* libxml2 is set up once, before any worker thread parses */
+	LIBXML_TEST_VERSION
+
+	if (getenv("SCHED_REACH_DENSE_MAX"))
+		reach_dense_max = strtoull(getenv("SCHED_REACH_DENSE_MAX"),
+					   NULL, 0);
+	pthread_once(&rta_vsum_once, rta_vsum_select);
+
+	if (argc > 1 && strcmp(argv[1], "compile") == 0) {
+		opt = compile(argc - 1, argv + 1);
+		xmlCleanupParser();
+		return opt;
+	}
+
+	if (argc > 1 && strcmp(argv[1], "batch") == 0) {
+		opt = batch(argc - 1, argv + 1);
+		xmlCleanupParser();
+		return opt;
+	}
+
+	if (argc > 1 && strcmp(argv[1], "serve") == 0) {
+		opt = serve(argc - 1, argv + 1);
+		xmlCleanupParser();
+		return opt;
+	}
+
+	wspec = (char **)malloc(argc * sizeof(char *));
+	if (!wspec)
+		err_exit("ERROR allocating options\n");
+
+	memset(&o, 0, sizeof(o));
+	o.f = stdout;
+	o.format = FORMAT_TEXT;
+	o.detail = OUT_ALL;
+
+	while ((opt = getopt_long(argc, argv, "j:s:r:x:w:ao:SM:m:", opts,
+				  NULL)) != -1) {
+		switch (opt) {
+		case 'M':
+			mc = atol(optarg);
+			if (mc < 1)
+				usage();
+			break;
+		case 'R':
+			seed = strtoull(optarg, NULL, 0);
+			seeded = 1;
+			break;
+		case 'B':
+			save = optarg;
+			break;
+		case 'W':
+			warm = optarg;
+			break;
+		case 'F':
+			if (strcmp(optarg, "text") == 0)
+				o.format = FORMAT_TEXT;
+			else if (strcmp(optarg, "json") == 0)
+				o.format = FORMAT_JSON;
+			else if (strcmp(optarg, "csv") == 0)
+				o.format = FORMAT_CSV;
+			else
+				usage();
+			break;
+		case 'q':
+			o.detail = OUT_VERDICT;
+			break;
+		case 'U':
+			if (o.detail != OUT_VERDICT)
+				o.detail = OUT_SUMMARY;
+			break;
+		case 'K':
+			o.top = atoi(optarg);
+			if (o.top < 1)
+				usage();
+			break;
+		case 'S':
+			slack = 1;
+			break;
+		case 'V':
+			verdict = 1;
+			break;
+		case 'T':
+			if (!optarg || strcmp(optarg, "table") == 0)
+				stats = STATS_TABLE;
+			else if (strcmp(optarg, "json") == 0)
+				stats = STATS_JSON;
+			else
+				usage();
+			break;
+		case 'a':
+			assign = 1;
+			break;
+		case 'm':
+			if (strcmp(optarg, "nodes") == 0)
+				map = MAP_NODES;
+			else if (strcmp(optarg, "util") == 0)
+				map = MAP_UTIL;
+			else
+				usage();
+			break;
+		case 'o':
+			out = optarg;
+			break;
+		case 'j':
+			nth = atoi(optarg);
+			if (nth == 0)
+				nth = sysconf(_SC_NPROCESSORS_ONLN);
+			if (nth < 1)
+				usage();
+			break;
+		case 'r':
+			if (tick_set_res(atoll(optarg)))
+				usage();
+			break;
+		case 'x':
+			rounds = atoi(optarg);
+			if (rounds < 0)
+				usage();
+			break;
+		case 'E':
+			exact = 1;
+			break;
+		case 's':
+			if (strcmp(optarg, "sweep") == 0)
+				solver = SOLVER_SWEEP;
+			else if (strcmp(optarg, "worklist") == 0)
+				solver = SOLVER_WORKLIST;
+			else
+				usage();
+			break;
+		case 'w':
+			wspec[nw++] = optarg;
+			break;
+		default:
+			usage();
+		}
+	}
+
+	if (optind != argc - 1 || (out && !assign && map < 0) ||
+	    (assign && map >= 0) || (seeded && !mc) ||
+	    (o.top && o.detail != OUT_ALL) ||
+	    (verdict && (assign || slack || nw || mc || map >= 0)) ||
+	    (o.format != FORMAT_TEXT &&
+	     (verdict || assign || slack || mc || map >= 0)))
+		usage();
+
+	/* the results can be large: fewer, bigger writes unless a tty */
+	if (!isatty(STDOUT_FILENO))
+		setvbuf(stdout, NULL, _IOFBF, OUT_BUF);
+
+	memset(&rs, 0, sizeof(rs));
+	phase_start(&total);
+
+	phase_start(&c);
+	if (taskset_load(&ts, argv[optind]))
+		err_exit("ERROR loading model %s\n", argv[optind]);
+	phase_stop(&c, &rs.load);
+
+	for (i = 0; i < ts.nt; i++) {
+		rs.closure.wall += ts.t[i].closure.wall;
+		rs.closure.cpu += ts.t[i].closure.cpu;
+		rs.length.wall += ts.t[i].length.wall;
+		rs.length.cpu += ts.t[i].length.cpu;
+	}
+	rs.parse.wall = rs.load.wall - rs.closure.wall - rs.length.wall;
+	rs.parse.cpu = rs.load.cpu - rs.closure.cpu - rs.length.cpu;
+
+	ts.nth = nth;
+	ts.solver = solver;
+	ts.rounds = rounds;
+	ts.exact = exact;
+	ts.verdict = verdict;
+
+	if (assign) {
+		static const char *res[] = {
+			"found",
+			"none exists (no vertex fits the lowest level)",
+			"none found"
+		};
+
+		phase_start(&c);
+		if (rta_opa(&ts, &i))
+			err_exit("ERROR assigning priorities\n");
+		phase_stop(&c, &rs.assign);
+
+		printf("Priority assignment: %s\n\n", res[i]);
+
+		if (i == OPA_FOUND && out) {
+			if (ts.map ? taskset_write(&ts, out) :
+			    xml_write_sched(&ts, argv[optind], out))
+				err_exit("ERROR writing %s\n", out);
+		}
+	}
+
+	if (map >= 0) {
+		struct cl_node **from;
+		int j, k;
+
+		from = (struct cl_node **)malloc(taskset_nv(&ts) *
+						 sizeof(struct cl_node *));
+		if (!from)
+			err_exit("ERROR allocating mapping\n");
+		for (i = 0, k = 0; i < ts.nt; i++)
+			for (j = 0; j < ts.t[i].nv; j++)
+				from[k++] = ts.t[i].v[j].n;
+
+		phase_start(&c);
+		if (rta_map(&ts, map, &i))
+			err_exit("ERROR exploring mappings\n");
+		phase_stop(&c, &rs.map);
+
+		if (map_print(&ts, from, i, map))
+			err_exit("ERROR allocating mapping\n");
+		free(from);
+
+		if (i == MAP_FOUND && out) {
+			if (ts.map ? taskset_write(&ts, out) :
+			    xml_write_sched(&ts, argv[optind], out))
+				err_exit("ERROR writing %s\n", out);
+		}
+	}
+
+	if (!verdict && o.format == FORMAT_TEXT && o.detail == OUT_ALL &&
+	    !o.top) {
+		phase_start(&c);
+		taskset_print(&ts);
+		phase_stop(&c, &rs.output);
+	}
+
+	if (warm)
+		wres = bounds_load(&ts, warm);
+
+	st = ts.st;
+	phase_start(&c);
+	if (rta(&ts, &sched))
+		err_exit("ERROR running sched. test\n"); 
+
+	/* a warm start only counts if it reached the fixed point */
+	if (ts.ystart && !ts.fixed) {
+		ts.ystart = 0;
+		wres = WARM_COLD;
+		if (rta(&ts, &sched))
+			err_exit("ERROR running sched. test\n");
+	}
+	phase_stop(&c, &rs.rta);
+
+	rs.prepare.wall = ts.st.prepare.wall - st.prepare.wall;
+	rs.prepare.cpu = ts.st.prepare.cpu - st.prepare.cpu;
+	rs.iter.wall = ts.st.iter.wall - st.iter.wall;
+	rs.iter.cpu = ts.st.iter.cpu - st.iter.cpu;
+	rs.nu = ts.nr;
+	rs.capped = ts.capped;
+	rs.fixed = ts.fixed;
+
+	if (verdict) {
+		phase_start(&c);
+		verdict_print(&ts, sched);
+		phase_stop(&c, &rs.output);
+	} else {
+		phase_start(&c);
+		if (out_results(&o, &ts, NULL, sched))
+			err_exit("ERROR writing the results\n");
+		if (warm && o.format == FORMAT_TEXT)
+			warm_print(warm, wres);
+		phase_stop(&c, &rs.output);
+	}
+
+	if (save && sched && ts.fixed && bounds_save(&ts, save))
+		err_exit("ERROR writing %s\n", save);
+
+	if (slack) {
+		tick_t *wcet;
+		double scale;
+
+		phase_start(&c);
+		if (rta_slack(&ts, &wcet, &scale))
+			err_exit("ERROR computing WCET slack\n");
+		phase_stop(&c, &rs.slack);
+
+		phase_start(&c);
+		printf("\n");
+		slack_print(&ts, wcet, scale);
+		free(wcet);
+		phase_stop(&c, &rs.output);
+	}
+
+	if (mc) {
+		struct mc_hist *hist;
+		long any;
+
+		phase_start(&c);
+		if (rta_montecarlo(&ts, mc, seed, &hist, &any))
+			err_exit("ERROR running Monte Carlo analysis\n");
+		phase_stop(&c, &rs.mc);
+
+		phase_start(&c);
+		printf("\n");
+		montecarlo_print(&ts, mc, seed, hist, any);
+		mc_hist_free(hist, ts.nt);
+		phase_stop(&c, &rs.output);
+	}
+
+	for (i = 0; i < nw; i++) {
+		struct whatif w;
+
+		if (whatif_parse(&ts, wspec[i], &w))
+			err_exit("ERROR parsing what-if %s\n", wspec[i]);
+
+		phase_start(&c);
+		if (rta_whatif(&ts, &w, &sched))
+			err_exit("ERROR running what-if %s\n", wspec[i]);
+		phase_stop(&c, &rs.whatif);
+
+		phase_start(&c);
+		if (out_results(&o, &ts, wspec[i], sched))
+			err_exit("ERROR writing the results\n");
+		phase_stop(&c, &rs.output);
+	}
+
+	phase_stop(&total, &rs.total);
+	/* not into a CSV stream, nor a table into JSON lines */
+	if (stats)
+		stats_print(o.format == FORMAT_CSV ||
+			    (o.format == FORMAT_JSON && stats == STATS_TABLE) ?
+			    stderr : stdout, &ts, &rs, stats);
+
+	if (taskset_finalize(&ts))
+		err_exit("taskset_finalize\n");
+
+	free(wspec);
+	xmlCleanupParser();
+	return verdict && !sched ? EXIT_UNSCHED : 0;
+}
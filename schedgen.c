@@ -0,0 +1,392 @@
+#include <getopt.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Synthetic taskset generator: writes JUNIPER XML models that sched
+ * accepts, from a seed and a handful of shape parameters. Chunks are
+ * emitted as they are drawn, so memory does not grow with the model.
+ */
+
+void err_exit(const char *format, ...)
+{
+	va_list arg_list;
+
+	va_start(arg_list, format);
+	vfprintf(stderr, format, arg_list);
+	va_end(arg_list);
+
+	exit(EXIT_FAILURE);
+}
+
+#define PRIO_MIN	0
+#define PRIO_MAX	100
+
+#define SHAPE_LAYERED	0	/* edges only between adjacent layers	*/
+#define SHAPE_RANDOM	1	/* any edge i -> j with i < j		*/
+
+#define PRIO_UNIFORM	0	/* uniform in [PRIO_MIN, PRIO_MAX]	*/
+#define PRIO_RM		1	/* by period, shortest highest		*/
+#define PRIO_PATH	2	/* by position in the DAG, first highest */
+
+struct gen {
+	int napps;		/* applications				*/
+	long nchunks;		/* chunks per application		*/
+	int shape;		/* SHAPE_*				*/
+	double density;		/* probability of each candidate edge	*/
+	long layers;		/* layers (SHAPE_LAYERED), 0 = sqrt	*/
+	int nodes;		/* CPU schedNodes per application	*/
+	int cpus;		/* CPUs per schedNode			*/
+	int io;			/* I/O schedNodes per application	*/
+	double util;		/* total utilisation of the taskset	*/
+	double pmin, pmax;	/* range of periods (log-uniform)	*/
+	double dratio;		/* deadline / period			*/
+	int prio;		/* PRIO_*				*/
+	uint64_t seed;
+
+	uint64_t rng;		/* xorshift64* state			*/
+};
+
+/* xorshift64*: the same stream for the same seed on every platform */
+uint64_t gen_next(struct gen *g)
+{
+	g->rng ^= g->rng >> 12;
+	g->rng ^= g->rng << 25;
+	g->rng ^= g->rng >> 27;
+
+	return g->rng * 2685821657736338717ULL;
+}
+
+/* uniform in [0, 1) */
+double gen_unif(struct gen *g)
+{
+	return (gen_next(g) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+long gen_range(struct gen *g, long lo, long hi)
+{
+	return lo + (long)(gen_unif(g) * (hi - lo + 1));
+}
+
+/* candidates skipped before the next edge, for edge probability p */
+long gen_skip(struct gen *g, double p)
+{
+	if (p >= 1.0)
+		return 0;
+
+	return (long)floor(log(1.0 - gen_unif(g)) / log(1.0 - p));
+}
+
+/*
+ * UUniFast, one share at a time: the next of n shares of a total sum,
+ * leaving the rest in *sum.
+ */
+double uunifast_next(struct gen *g, double *sum, long n)
+{
+	double next, share;
+
+	if (n <= 1) {
+		share = *sum;
+		*sum = 0.0;
+		return share;
+	}
+
+	next = *sum * pow(gen_unif(g), 1.0 / (n - 1));
+	share = *sum - next;
+	*sum = next;
+
+	return share;
+}
+
+long layer_start(struct gen *g, long layers, long k)
+{
+	return (long)((double)k * g->nchunks / layers);
+}
+
+int gen_prio(struct gen *g, double period, long i)
+{
+	double lp;
+
+	switch (g->prio) {
+	case PRIO_RM:
+		if (g->pmax <= g->pmin)
+			return PRIO_MAX;
+		lp = log(period / g->pmin) / log(g->pmax / g->pmin);
+		return PRIO_MAX - (int)lround(lp * (PRIO_MAX - PRIO_MIN));
+	case PRIO_PATH:
+		return PRIO_MAX - (int)((double)i * (PRIO_MAX - PRIO_MIN + 1) /
+					g->nchunks);
+	}
+
+	return (int)gen_range(g, PRIO_MIN, PRIO_MAX);
+}
+
+void gen_node(FILE *f, const char *name, const char *res, int n)
+{
+	int k;
+
+	fprintf(f, "\t\t<schedNode name=\"%s\">\n", name);
+	for (k = 0; k < n; k++)
+		fprintf(f, "\t\t\t<%s id=\"%s.%s%d\" />\n", res, name, res, k);
+	fprintf(f, "\t\t</schedNode>\n");
+}
+
+void gen_chunk(struct gen *g, FILE *f, long i, long layers, double period,
+	       double *vol)
+{
+	long j, end, worst, best, value, node;
+	char name[32];
+
+	node = gen_range(g, 0, g->nodes + g->io - 1);
+	if (node < g->nodes)
+		snprintf(name, sizeof(name), "cpu%ld", node);
+	else
+		snprintf(name, sizeof(name), "io%ld", node - g->nodes);
+
+	fprintf(f, "\t\t\t<chunk id=\"c%ld\" schedNode=\"%s\">\n", i, name);
+
+	if (g->shape == SHAPE_LAYERED) {
+		long k = (long)((double)i * layers / g->nchunks);
+
+		while (layer_start(g, layers, k + 1) <= i)
+			k++;
+
+		j = layer_start(g, layers, k + 1);
+		end = k + 1 < layers ? layer_start(g, layers, k + 2) : j;
+	} else {
+		j = i + 1;
+		end = g->nchunks;
+	}
+
+	if (g->density > 0.0) {
+		for (j += gen_skip(g, g->density); j < end;
+		     j += 1 + gen_skip(g, g->density))
+			fprintf(f, "\t\t\t\t<successor id=\"c%ld\" />\n", j);
+	}
+
+	worst = lround(uunifast_next(g, vol, g->nchunks - i));
+	if (worst < 1)
+		worst = 1;
+	best = gen_range(g, (worst + 3) / 4, worst);
+	value = gen_range(g, best, worst);
+
+	fprintf(f, "\t\t\t\t<rtSpecification priority=\"%d\">\n",
+		gen_prio(g, period, i));
+	fprintf(f, "\t\t\t\t\t<relDl best=\"%ld\" value=\"%ld\""
+		" worst=\"%ld\" prob=\"1.0\" />\n", best, value, worst);
+	fprintf(f, "\t\t\t\t</rtSpecification>\n");
+	fprintf(f, "\t\t\t</chunk>\n");
+}
+
+void gen_app(struct gen *g, FILE *f, int a, double util)
+{
+	double period, vol;
+	long layers, i;
+	char name[32];
+	int k;
+
+	period = round(g->pmin * pow(g->pmax / g->pmin, gen_unif(g)));
+	if (period < 1.0)
+		period = 1.0;
+	vol = util * period;
+
+	layers = g->layers ? g->layers : (long)ceil(sqrt(g->nchunks));
+	if (layers > g->nchunks)
+		layers = g->nchunks;
+
+	fprintf(f, "<application name=\"app%d\">\n", a);
+	fprintf(f, "\t<softwareModel>\n");
+	fprintf(f, "\t\t<program javaClass=\"app%d.Main\">\n", a);
+	fprintf(f, "\t\t\t<requestResponseStream id=\"app%d.stream\""
+		" name=\"stream\" requiresResponse=\"false\">\n", a);
+	fprintf(f, "\t\t\t\t<rtSpecification>\n");
+	fprintf(f, "\t\t\t\t\t<relDl>%.0f</relDl>\n",
+		fmax(1.0, round(period * g->dratio)));
+	fprintf(f, "\t\t\t\t\t<occKind period=\"%.0f\"/>\n", period);
+	fprintf(f, "\t\t\t\t</rtSpecification>\n");
+	fprintf(f, "\t\t\t</requestResponseStream>\n");
+	fprintf(f, "\t\t</program>\n");
+	fprintf(f, "\t</softwareModel>\n");
+
+	fprintf(f, "\t<schedModel>\n");
+	for (k = 0; k < g->nodes; k++) {
+		snprintf(name, sizeof(name), "cpu%d", k);
+		gen_node(f, name, "cpu", g->cpus);
+	}
+	for (k = 0; k < g->io; k++) {
+		snprintf(name, sizeof(name), "io%d", k);
+		gen_node(f, name, "disk", 1);
+	}
+	fprintf(f, "\t</schedModel>\n");
+
+	fprintf(f, "\t<behaviorModel>\n");
+	fprintf(f, "\t\t<behaviorSpecification id=\"app%d.behavior\">\n", a);
+	for (i = 0; i < g->nchunks; i++)
+		gen_chunk(g, f, i, layers, period, &vol);
+	fprintf(f, "\t\t</behaviorSpecification>\n");
+	fprintf(f, "\t</behaviorModel>\n");
+	fprintf(f, "</application>\n");
+}
+
+int generate(struct gen *g, FILE *f)
+{
+	double util = g->util;
+	int a;
+
+	g->rng = g->seed * 0x9e3779b97f4a7c15ULL + 1;
+	if (!g->rng)
+		g->rng = 1;
+
+	fprintf(f, "<?xml version=\"1.0\"?>\n");
+	fprintf(f, "<!-- schedgen -n %d -c %ld -g %s -d %g -l %ld -N %d"
+		" -m %d -i %d -u %g -p %g:%g -D %g -P %s -s %llu -->\n",
+		g->napps, g->nchunks,
+		g->shape == SHAPE_LAYERED ? "layered" : "random",
+		g->density, g->layers, g->nodes, g->cpus, g->io, g->util,
+		g->pmin, g->pmax, g->dratio,
+		g->prio == PRIO_RM ? "rm" :
+		g->prio == PRIO_PATH ? "path" : "uniform",
+		(unsigned long long)g->seed);
+	fprintf(f, "<juniper>\n");
+
+	for (a = 0; a < g->napps; a++)
+		gen_app(g, f, a, uunifast_next(g, &util, g->napps - a));
+
+	fprintf(f, "</juniper>\n");
+
+	return ferror(f);
+}
+
+void usage(void)
+{
+	err_exit("Usage: schedgen [-n apps] [-c chunks] [-g layered|random]"
+		 " [-d density] [-l layers]\n"
+		 "                [-N nodes] [-m cpus] [-i io-nodes]"
+		 " [-u util] [-p min:max] [-D ratio]\n"
+		 "                [-P uniform|rm|path] [-s seed]"
+		 " [-o file.xml]\n");
+}
+
+int main(int argc, char **argv)
+{
+	static struct option opts[] = {
+		{ "apps",	required_argument,	NULL, 'n' },
+		{ "chunks",	required_argument,	NULL, 'c' },
+		{ "shape",	required_argument,	NULL, 'g' },
+		{ "density",	required_argument,	NULL, 'd' },
+		{ "layers",	required_argument,	NULL, 'l' },
+		{ "nodes",	required_argument,	NULL, 'N' },
+		{ "cpus",	required_argument,	NULL, 'm' },
+		{ "io-nodes",	required_argument,	NULL, 'i' },
+		{ "util",	required_argument,	NULL, 'u' },
+		{ "period",	required_argument,	NULL, 'p' },
+		{ "deadline",	required_argument,	NULL, 'D' },
+		{ "prio",	required_argument,	NULL, 'P' },
+		{ "seed",	required_argument,	NULL, 's' },
+		{ "output",	required_argument,	NULL, 'o' },
+		{ NULL,		0,			NULL, 0 }
+	};
+	struct gen g = {
+		.napps = 1,
+		.nchunks = 10,
+		.shape = SHAPE_LAYERED,
+		.density = 0.3,
+		.layers = 0,
+		.nodes = 2,
+		.cpus = 2,
+		.io = 0,
+		.util = 0.5,
+		.pmin = 100.0,
+		.pmax = 10000.0,
+		.dratio = 1.0,
+		.prio = PRIO_UNIFORM,
+		.seed = 1,
+	};
+	char *out = NULL;
+	FILE *f = stdout;
+	int opt;
+
+	while ((opt = getopt_long(argc, argv, "n:c:g:d:l:N:m:i:u:p:D:P:s:o:",
+				  opts, NULL)) != -1) {
+		switch (opt) {
+		case 'n':
+			g.napps = atoi(optarg);
+			break;
+		case 'c':
+			g.nchunks = atol(optarg);
+			break;
+		case 'g':
+			if (strcmp(optarg, "layered") == 0)
+				g.shape = SHAPE_LAYERED;
+			else if (strcmp(optarg, "random") == 0)
+				g.shape = SHAPE_RANDOM;
+			else
+				usage();
+			break;
+		case 'd':
+			g.density = atof(optarg);
+			break;
+		case 'l':
+			g.layers = atol(optarg);
+			break;
+		case 'N':
+			g.nodes = atoi(optarg);
+			break;
+		case 'm':
+			g.cpus = atoi(optarg);
+			break;
+		case 'i':
+			g.io = atoi(optarg);
+			break;
+		case 'u':
+			g.util = atof(optarg);
+			break;
+		case 'p':
+			if (sscanf(optarg, "%lf:%lf", &g.pmin, &g.pmax) != 2)
+				usage();
+			break;
+		case 'D':
+			g.dratio = atof(optarg);
+			break;
+		case 'P':
+			if (strcmp(optarg, "uniform") == 0)
+				g.prio = PRIO_UNIFORM;
+			else if (strcmp(optarg, "rm") == 0)
+				g.prio = PRIO_RM;
+			else if (strcmp(optarg, "path") == 0)
+				g.prio = PRIO_PATH;
+			else
+				usage();
+			break;
+		case 's':
+			g.seed = strtoull(optarg, NULL, 0);
+			break;
+		case 'o':
+			out = optarg;
+			break;
+		default:
+			usage();
+		}
+	}
+
+	if (optind != argc || g.napps < 1 || g.nchunks < 1 ||
+	    g.density < 0.0 || g.density > 1.0 || g.layers < 0 ||
+	    g.nodes < 1 || g.cpus < 1 || g.io < 0 || g.util <= 0.0 ||
+	    g.pmin < 1.0 || g.pmax < g.pmin || g.dratio <= 0.0)
+		usage();
+
+	if (out) {
+		f = fopen(out, "w");
+		if (!f)
+			err_exit("ERROR opening %s\n", out);
+	}
+
+	if (generate(&g, f) || (out && fclose(f)))
+		err_exit("ERROR writing %s\n", out ? out : "output");
+
+	return 0;
+}
@@ -0,0 +1,74 @@
+/*
+ * Minimal client of "sched serve", for make check: sends every argument
+ * after the socket path as one request and prints the responses in
+ * order. Exits with 1 if a request fails or is answered with an error.
+ */
+#include <arpa/inet.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+int io_full(int fd, void *buf, size_t len, int out)
+{
+	ssize_t n;
+
+	while (len > 0) {
+		n = out ? write(fd, buf, len) : read(fd, buf, len);
+		if (n <= 0)
+			return 1;
+
+		buf = (char *)buf + n;
+		len -= n;
+	}
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	struct sockaddr_un addr;
+	uint32_t len;
+	char *resp;
+	int fd, i, ret = 0;
+
+	if (argc < 3 || strlen(argv[1]) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "Usage: client <socket> <request>...\n");
+		return 1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, argv[1]);
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+		fprintf(stderr, "ERROR connecting to %s\n", argv[1]);
+		return 1;
+	}
+
+	for (i = 2; i < argc; i++) {
+		len = htonl(strlen(argv[i]));
+		if (io_full(fd, &len, sizeof(len), 1) ||
+		    io_full(fd, argv[i], strlen(argv[i]), 1) ||
+		    io_full(fd, &len, sizeof(len), 0))
+			return 1;
+
+		len = ntohl(len);
+		resp = (char *)malloc(len + 1);
+		if (!resp || io_full(fd, resp, len, 0))
+			return 1;
+		resp[len] = '\0';
+
+		fputs(resp, stdout);
+		if (strncmp(resp, "error", 5) == 0)
+			ret = 1;
+		free(resp);
+	}
+
+	close(fd);
+	return ret;
+}